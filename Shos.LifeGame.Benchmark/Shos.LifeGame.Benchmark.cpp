@@ -0,0 +1,215 @@
+#include "../Shos.LifeGame/ShosLifeGame.h"
+#include "../Shos.LifeGame/ShosStopwatch.h"
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <iomanip>
+#include <string>
+#include <cstdlib>
+using namespace std;
+
+// Runs a pattern for a number of generations without a window, and writes a row of Articles(Japanese)/ShosLifeGame_BenchmarkData.csv.
+//
+// Usage: Shos.LifeGame.Benchmark [options]
+//   --pattern NAME      A pattern in the pattern folder (Gun_Gunstar); "Random" for a random board
+//   --cells FOLDER      The pattern folder (CellData)
+//   --width WIDTH       Board width  (1000)
+//   --height HEIGHT     Board height (1000)
+//   --generations COUNT Number of generations (1000)
+//   --threads COUNT     Number of threads with MT; 0 means one per hardware thread (0)
+//   --depth COUNT       Generations per sweep over the board, with temporal blocking above 1; 1 runs them all with Game::Advance (1)
+//   --output FILE       Appends the row to FILE, with the header if FILE is empty; otherwise writes to the standard output
+//   --header            Writes the header before the row to the standard output
+//   --trace FILE        Writes the trace events of the run to FILE, for chrome://tracing or Perfetto (built with TRACE)
+//
+// Built with PROFILE, the timings of the phases of the generations are written to the standard error output.
+//
+// The optimizations are chosen at compile time; the optimization level is the one of the article:
+// 0: none, 1: USEBITS, 2: + FAST, 3: + MT, 4: + AREA, 5: + SIMD.
+
+#if defined(USEBITS) && defined(FAST) && defined(MT) && defined(AREA) && defined(SIMD)
+#define OPTIMIZATION_LEVEL 5
+#elif defined(USEBITS) && defined(FAST) && defined(MT) && defined(AREA)
+#define OPTIMIZATION_LEVEL 4
+#elif defined(USEBITS) && defined(FAST) && defined(MT)
+#define OPTIMIZATION_LEVEL 3
+#elif defined(USEBITS) && defined(FAST)
+#define OPTIMIZATION_LEVEL 2
+#elif defined(USEBITS)
+#define OPTIMIZATION_LEVEL 1
+#else // USEBITS
+#define OPTIMIZATION_LEVEL 0
+#endif // USEBITS
+
+namespace Shos::LifeGame::Benchmark {
+    using namespace Shos::LifeGame;
+
+    struct Options
+    {
+        string       pattern     = "Gun_Gunstar";
+        string       cells       = "CellData";
+        Integer      width       = 1000;
+        Integer      height      = 1000;
+        unsigned int generations = 1000U;
+        unsigned int threads     = 0U;
+        unsigned int depth       = 1U;
+        string       output;
+        bool         header      = false;
+#if defined(TRACE)
+        string       trace;
+#endif // TRACE
+
+        bool Parse(int argc, char* argv[])
+        {
+            for (auto index = 1; index < argc; index++) {
+                const string option = argv[index];
+                if (option == "--header") {
+                    header = true;
+                    continue;
+                }
+                if (index + 1 >= argc)
+                    return false;
+
+                const string value = argv[++index];
+                if      (option == "--pattern"    ) pattern     = value;
+                else if (option == "--cells"      ) cells       = value;
+                else if (option == "--width"      ) width       = Integer(stoi(value));
+                else if (option == "--height"     ) height      = Integer(stoi(value));
+                else if (option == "--generations") generations = unsigned(stoul(value));
+                else if (option == "--threads"    ) threads     = unsigned(stoul(value));
+                else if (option == "--depth"      ) depth       = unsigned(stoul(value));
+                else if (option == "--output"     ) output      = value;
+#if defined(TRACE)
+                else if (option == "--trace"      ) trace       = value;
+#endif // TRACE
+                else                                return false;
+            }
+            return width > 0 && height > 0 && depth > 0U;
+        }
+    };
+
+    class Program
+    {
+        static constexpr auto header = "Optimization Level,USEBITS (Bits enabled),FAST (Fast loops enabled),MT (Multi-threading enabled),AREA (Area enabled),"
+                                       "Pattern,Board width,Board height,Number of generations,Time (seconds),FPS (Frames Per Second)";
+
+#if defined(USEBITS)
+        static constexpr bool useBits = true;
+#else // USEBITS
+        static constexpr bool useBits = false;
+#endif // USEBITS
+#if defined(FAST)
+        static constexpr bool fast    = true;
+#else // FAST
+        static constexpr bool fast    = false;
+#endif // FAST
+#if defined(MT)
+        static constexpr bool mt      = true;
+#else // MT
+        static constexpr bool mt      = false;
+#endif // MT
+#if defined(AREA)
+        static constexpr bool area    = true;
+#else // AREA
+        static constexpr bool area    = false;
+#endif // AREA
+
+    public:
+        int Run(int argc, char* argv[])
+        {
+            Options options;
+            try {
+                if (!options.Parse(argc, argv)) {
+                    cerr << "Usage: " << argv[0] << " [--pattern NAME] [--cells FOLDER] [--width WIDTH] [--height HEIGHT] [--generations COUNT] [--threads COUNT] [--depth COUNT] [--output FILE] [--header]" << endl;
+                    return EXIT_FAILURE;
+                }
+            } catch (const exception&) {
+                cerr << "Invalid number." << endl;
+                return EXIT_FAILURE;
+            }
+
+#if defined(MT)
+            Game game({ options.width, options.height }, options.threads);
+#else // MT
+            Game game({ options.width, options.height });
+#endif // MT
+            if (options.pattern != "Random") {
+                game.ReadPatterns(tstring(options.cells.begin(), options.cells.end()));
+                if (!game.SetPattern(game.FindPattern(tstring(options.pattern.begin(), options.pattern.end())))) {
+                    cerr << "Pattern " << options.pattern << " is not found in " << options.cells << " or does not fit in the board." << endl;
+                    return EXIT_FAILURE;
+                }
+            }
+
+#if defined(TRACE)
+            if (!options.trace.empty())
+                Tracer::Start();
+#endif // TRACE
+            stopwatch stopwatch;
+            stopwatch.start();
+            if (options.depth == 1U) {
+                game.Advance(options.generations);
+            } else {
+                for (auto count = 0U; count < options.generations; count += options.depth)
+                    game.NextBlocked(std::min(options.depth, options.generations - count));
+            }
+            const auto elapsed = stopwatch.get_elapsed();
+#if defined(PROFILE)
+            game.GetProfiler().Write(cerr);
+#endif // PROFILE
+#if defined(TRACE)
+            if (!options.trace.empty()) {
+                Tracer::Stop();
+                ofstream traceStream(options.trace);
+                Tracer::Write(traceStream);
+                if (!traceStream) {
+                    cerr << "Cannot write " << options.trace << "." << endl;
+                    return EXIT_FAILURE;
+                }
+            }
+#endif // TRACE
+
+            if (options.output.empty()) {
+                if (options.header)
+                    cout << header << endl;
+                Write(cout, options, elapsed);
+                return EXIT_SUCCESS;
+            }
+
+            error_code error;
+            const auto isEmpty = filesystem::file_size(options.output, error) == 0U || error;
+            ofstream   stream(options.output, ios::app);
+            if (!stream.is_open()) {
+                cerr << "Cannot open " << options.output << "." << endl;
+                return EXIT_FAILURE;
+            }
+            if (isEmpty)
+                stream << header << endl;
+            Write(stream, options, elapsed);
+            return EXIT_SUCCESS;
+        }
+
+    private:
+        static const char* ToString(bool value)
+        { return value ? "TRUE" : "FALSE"; }
+
+        static void Write(ostream& stream, const Options& options, double elapsed)
+        {
+            stream << OPTIMIZATION_LEVEL                  << ','
+                   << ToString(useBits)                   << ','
+                   << ToString(fast   )                   << ','
+                   << ToString(mt     )                   << ','
+                   << ToString(area   )                   << ','
+                   << options.pattern                     << ','
+                   << options.width                       << ','
+                   << options.height                      << ','
+                   << options.generations                 << ','
+                   << fixed << setprecision(3) << elapsed << ','
+                   << setprecision(0) << (elapsed > 0.0 ? options.generations / elapsed : 0.0)
+                   << endl;
+        }
+    };
+}
+
+int main(int argc, char* argv[])
+{ return Shos::LifeGame::Benchmark::Program().Run(argc, argv); }
@@ -2,6 +2,12 @@
 #include "../Shos.LifeGame/ShosStopwatch.h"
 #include <thread>
 #include <vector>
+#include <filesystem>
+#include <fstream>
+#include <cstring>
+#include <random>
+#include <set>
+#include <map>
 using namespace std;
 
 // Result:
@@ -14,6 +20,8 @@ namespace Shos::LifeGame::Test {
 
     class Program
     {
+        bool isPassed = true;
+
     public:
         void Run()
         {
@@ -21,13 +29,377 @@ namespace Shos::LifeGame::Test {
             const size_t times =  100;
 
             Shos::LifeGame::Game game({ size, size });
+            cout << "Instruction set: " << Kernel::GetInstructionSetName() << endl;
 
             Shos::stopwatch_viewer stopwatch_viewer;
-            for (auto count = 0; count < times; count++)
-                game.Next();
+            game.Advance(times);
+#if defined(PROFILE)
+            game.GetProfiler().Write(cout);
+#endif // PROFILE
+        }
+
+        /// <summary>Runs the regression tests of the pattern files and the checkpoints.</summary>
+        /// <returns>true if all of them pass.</returns>
+        bool Check()
+        {
+            const auto folder = filesystem::temp_directory_path() / "Shos.LifeGame.Test";
+            filesystem::remove_all(folder);
+            filesystem::create_directories(folder);
+
+            CheckKernels();
+            CheckPatternFiles(folder);
+            CheckMalformedFiles(folder / "Malformed");
+            CheckEngines(folder / "Engines");
+#if !defined(HASHLIFE) && !defined(SPARSE)
+            CheckCheckpoints(folder);
+#endif // !HASHLIFE && !SPARSE
+
+            filesystem::remove_all(folder);
+            return isPassed;
+        }
+
+    private:
+        void Expect(bool condition, const char* name)
+        {
+            cout << (condition ? "OK: " : "NG: ") << name << endl;
+            isPassed = isPassed && condition;
+        }
+
+        static tstring ToFilePath(const filesystem::path& path)
+        {
+#if defined(UNICODE) || defined(_UNICODE)
+            return path.wstring();
+#else // UNICODE
+            return path.string ();
+#endif // UNICODE
+        }
+
+        /// <summary>The alive cells, moved so that the bounds of them start at the origin.</summary>
+        template <typename TForEachAlive>
+        static vector<Point> GetCells(TForEachAlive forEachAlive)
+        {
+            vector<Point> cells;
+            forEachAlive([&](const Point& point) { cells.push_back(point); });
+            if (cells.empty())
+                return cells;
+
+            auto leftTop = cells.front();
+            for (const auto& cell : cells) {
+                leftTop.x = std::min(leftTop.x, cell.x);
+                leftTop.y = std::min(leftTop.y, cell.y);
+            }
+            for (auto& cell : cells)
+                cell = Point(cell.x - leftTop.x, cell.y - leftTop.y);
+            sort(cells.begin(), cells.end(), [](const Point& point1, const Point& point2) { return point1.y != point2.y ? point1.y < point2.y : point1.x < point2.x; });
+            return cells;
+        }
+
+        static vector<Point> GetCells(const Game& game)
+        {
+            return GetCells([&](auto action) {
+                const auto size = game.GetBoard().GetSize();
+                for (auto point = Point(); point.y < size.cy; point.y++) {
+                    for (point.x = 0; point.x < size.cx; point.x++) {
+                        if (game.GetBoard().Get(point))
+                            action(point);
+                    }
+                }
+            });
+        }
+
+        static bool IsSame(const Game& game1, const Game& game2)
+        {
+            const auto size = game1.GetBoard().GetSize();
+            for (auto point = Point(); point.y < size.cy; point.y++) {
+                for (point.x = 0; point.x < size.cx; point.x++) {
+                    if (game1.GetBoard().Get(point) != game2.GetBoard().Get(point))
+                        return false;
+                }
+            }
+            return true;
+        }
+
+        /// <summary>The alive cells generationNumber generations later in an unbounded universe, with the rule applied to each cell.</summary>
+        static vector<Point> GetNextCells(const vector<Point>& cells, const Rule& rule, unsigned int generationNumber)
+        {
+            set<pair<Integer, Integer>> alive;
+            for (const auto& cell : cells)
+                alive.emplace(cell.x, cell.y);
+
+            for (auto generation = 0U; generation < generationNumber; generation++) {
+                map<pair<Integer, Integer>, UnsignedInteger> aliveNeighborCounts;
+                for (const auto& [x, y] : alive) {
+                    aliveNeighborCounts.try_emplace({ x, y }, 0U);
+                    for (auto dy = -1; dy <= 1; dy++) {
+                        for (auto dx = -1; dx <= 1; dx++) {
+                            if (dx != 0 || dy != 0)
+                                aliveNeighborCounts[{ x + dx, y + dy }]++;
+                        }
+                    }
+                }
+
+                set<pair<Integer, Integer>> next;
+                for (const auto& [cell, aliveNeighborCount] : aliveNeighborCounts) {
+                    if (rule.IsAlive(alive.count(cell) != 0U, aliveNeighborCount))
+                        next.insert(cell);
+                }
+                alive.swap(next);
+            }
+            return GetCells([&](auto action) {
+                for (const auto& [x, y] : alive)
+                    action(Point(x, y));
+            });
+        }
+
+        /// <summary>
+        /// Computes random rows with the kernels of each instruction set the CPU supports, and compares them bit for bit
+        /// with the rule applied to each cell.
+        /// </summary>
+        void CheckKernels()
+        {
+            constexpr Integer bitNumber = Integer(sizeof(UnitInteger) * 8);
+
+            const Rule    rules [] = { Rule::Conway(), Rule::HighLife(), Rule::DayAndNight(), Rule::Seeds(), Rule(0b1000, 0b0110) }; // B3/S12 has no kernel of its own
+            const Integer widths[] = { 1, 63, 64, 65, 64 * 8 + 37, 2048 }; // 64 * 8 + 37 cells are not a whole number of vectors of any width
+
+            const auto detected = Kernel::GetInstructionSet();
+            mt19937_64 random(2023);
+            for (auto instructionSet : { InstructionSet::Scalar, InstructionSet::Sse2, InstructionSet::Avx2, InstructionSet::Avx512 }) {
+                Kernel::SetInstructionSet(instructionSet);
+                if (Kernel::GetInstructionSet() != instructionSet)
+                    continue;
+
+                auto isSame = true;
+                for (const auto& rule : rules) {
+                    const RuleKernel kernel(rule);
+                    for (const auto width : widths) {
+                        for (auto trial = 0; trial < 8; trial++) {
+                            // Three rows with a dead unit on each side, as the kernel reads the units next to the ones it computes.
+                            const auto          unitNumber   = (width + bitNumber - 1) / bitNumber;
+                            const auto          stride       = unitNumber + 2;
+                            const auto          lastUnitMask = width % bitNumber == 0 ? ~UnitInteger(0) : (UnitInteger(1) << (width % bitNumber)) - 1U;
+                            vector<UnitInteger> rows(size_t(stride) * 3U);
+                            for (auto y = 0; y < 3; y++) {
+                                for (auto index = 0; index < unitNumber; index++)
+                                    rows[size_t(stride * y + 1 + index)] = random();
+                                rows[size_t(stride * y + unitNumber)] &= lastUnitMask;
+                            }
+                            const auto center  = rows.data() + stride + 1;
+                            const auto isAlive = [&](Integer x, Integer y) {
+                                return 0 <= x && x < width && (center[stride * y + x / bitNumber] >> (x % bitNumber) & 1U) != 0U;
+                            };
+
+                            vector<UnitInteger> next(size_t(unitNumber), 0U);
+                            kernel.NextRow(center, UnsignedInteger(stride), next.data(), 0U, UnsignedInteger(unitNumber));
+                            next.back() &= lastUnitMask;
+
+                            for (auto x = 0; x < width; x++) {
+                                auto aliveNeighborCount = 0U;
+                                for (auto y = -1; y <= 1; y++) {
+                                    for (auto dx = -1; dx <= 1; dx++)
+                                        aliveNeighborCount += (y != 0 || dx != 0) && isAlive(x + dx, y) ? 1U : 0U;
+                                }
+                                isSame = isSame && ((next[size_t(x / bitNumber)] >> (x % bitNumber) & 1U) != 0U) == rule.IsAlive(isAlive(x, 0), aliveNeighborCount);
+                            }
+                        }
+                    }
+                }
+                Expect(isSame, (string("Kernel of ") + Kernel::GetInstructionSetName() + " matches the rule of each cell").c_str());
+            }
+            Kernel::SetInstructionSet(detected);
+        }
+
+        /// <summary>Writes a board as RLE, Life 1.05 and Macrocell, and reads the files back through PatternSet.</summary>
+        void CheckPatternFiles(const filesystem::path& folder)
+        {
+            Game game({ 200, 150 });
+            game.SetRule(Rule::HighLife());
+            {
+                ofstream rle (folder / "Board.rle");
+                ofstream life(folder / "Board.lif");
+                ofstream mc  (folder / "Board.mc" );
+                game.WriteRle      (rle );
+                game.WriteLife     (life);
+                game.WriteMacrocell(mc  );
+            }
+
+            const auto cells = GetCells(game);
+            PatternSet patternSet(ToFilePath(folder));
+            Expect(patternSet.GetSize() == 3U, "PatternSet reads the written files");
+            for (auto index = size_t(0); index < patternSet.GetSize(); index++) {
+                const auto pattern = patternSet.Get(index);
+                const auto format  = patternSet.GetHeader(index).format;
+                const auto name    = format == PatternSet::Format::Rle ? "RLE round trip" : format == PatternSet::Format::Life ? "Life 1.05 round trip" : "Macrocell round trip";
+                Expect(pattern->GetRule() == Rule::HighLife() && GetCells([&](auto action) { pattern->ForEachAlive(action); }) == cells, name);
+            }
+        }
+
+        /// <summary>
+        /// Reads RLE files with sizes that are not valid and pattern files with a rule that is not supported, which give empty patterns,
+        /// and an RLE file with a run longer than the row.
+        /// </summary>
+        void CheckMalformedFiles(const filesystem::path& folder)
+        {
+            filesystem::create_directories(folder);
+            const pair<const char*, const char*> files[] = {
+                { "Negative.rle"       , "x = -3, y = 1\n3o!\n"                   },
+                { "Zero.rle"           , "x = 0, y = 0\n3o!\n"                    },
+                { "Oversized.rle"      , "x = 2000000000, y = 2000000000\n3o!\n"  },
+                { "Overflow.rle"       , "x = 99999999999999999999, y = 1\n3o!\n" },
+                { "NotNumber.rle"      , "x = 3o, y = 1\n3o!\n"                   },
+                { "BornFromNothing.rle", "x = 3, y = 1, rule = B03/S23\n3o!\n"    },
+                { "BornFromNothing.lif", "#Life 1.05\n#R 23/03\n***\n"            },
+                { "LongRun.rle"        , "x = 3, y = 2\n4294967297o$o!\n"         }
+            };
+            for (const auto& [name, text] : files)
+                ofstream(folder / name) << text;
+
+            PatternSet patternSet(ToFilePath(folder));
+            auto       isEmpty = true;
+            for (auto index = size_t(0); index < patternSet.GetSize(); index++) {
+                const auto& header  = patternSet.GetHeader(index);
+                const auto  pattern = patternSet.Get(index);
+                if (header.name == _T("LongRun"))
+                    Expect(pattern->GetSize() == Size(3, 2) && GetCells([&](auto action) { pattern->ForEachAlive(action); }) == vector<Point>{ { 0, 0 }, { 1, 0 }, { 2, 0 }, { 0, 1 } }, "RLE run longer than the row is cut at the width");
+                else
+                    isEmpty = isEmpty && header.size == Size() && pattern->GetSize() == Size();
+            }
+            Expect(patternSet.GetSize() == size(files) && isEmpty, "Pattern files with a negative, zero, oversized or unparsable size, or an unsupported rule, are empty");
+
+            Game game({ 16, 16 });
+            game.ReadPatterns(ToFilePath(folder));
+            Expect(!game.SetPattern(game.FindPattern(_T("BornFromNothing"))), "Pattern with an unsupported rule is not set");
+        }
+
+        /// <summary>
+        /// Advances a seeded random board, a glider gun and a glider hitting a block with the engine this program is built with,
+        /// and compares them with the rule applied to each cell. No cell gets farther than a cell a generation from the center of the board,
+        /// so the patterns stay clear of the edges and bounded and unbounded engines agree; the gliders of the gun leave
+        /// tiles and chunks behind, so that those die while others are born. With CYCLE, Seek is compared with Next too.
+        /// </summary>
+        void CheckEngines(const filesystem::path& folder)
+        {
+            constexpr auto size             = 32;
+            constexpr auto generationNumber = 384U;
+
+            filesystem::create_directories(folder);
+            mt19937_64 random(2023);
+            string     soup = "x = 32, y = 32, rule = B36/S23\n";
+            for (auto y = 0; y < size; y++) {
+                for (auto x = 0; x < size; x++)
+                    soup += random() % 2U == 0U ? 'o' : 'b';
+                soup += y + 1 < size ? "$\n" : "!\n";
+            }
+            ofstream(folder / "Soup.rle") << soup;
+            ofstream(folder / "Gun.rle" ) << "x = 36, y = 9, rule = B3/S23\n"
+                                             "24bo$22bobo$12b2o6b2o12b2o$11bo3bo4b2o12b2o$2o8bo5bo3b2o$2o8bo3bob2o4bobo$10bo5bo7bo$11bo3bo$12b2o!\n";
+            // The glider gets to the block, which is in another tile, long after that tile has frozen.
+            ofstream(folder / "Collision.rle") << "x = 62, y = 62, rule = B3/S23\nbo$2bo$3o58$60b2o$60b2o!\n";
+
+            const pair<tstring, string> patterns[] = { { _T("Soup"), "seeded random board" }, { _T("Gun"), "glider gun" }, { _T("Collision"), "glider hitting a block" } };
+            for (const auto& [name, description] : patterns) {
+                // Runs step on a new game with the pattern, and compares it with generationNumber generations of the rule.
+                const auto isSame = [&, name = name](auto step) {
+#if defined(MT)
+                    Game game({ 1024, 1024 }, 4U); // workers enough for Advance to run its bands, whatever the CPU
+#else // MT
+                    Game game({ 1024, 1024 });
+#endif // MT
+                    game.ReadPatterns(ToFilePath(folder));
+                    if (!game.SetPattern(game.FindPattern(name)))
+                        return false;
+                    const auto expected = GetNextCells(GetCells(game), game.GetRule(), generationNumber);
+                    step(game);
+                    return game.GetGeneration() == generationNumber && GetCells(game) == expected;
+                };
+
+                Expect(isSame([](Game& game) {
+                    for (auto count = 0U; count < generationNumber; count++)
+                        game.Next();
+                }), ("Next of a " + description + " matches the rule of each cell").c_str());
+                Expect(isSame([](Game& game) {
+                    for (auto count = 0U; count < generationNumber; count += 7U)
+                        game.NextBlocked(std::min(7U, generationNumber - count)); // an odd depth, and a shorter one at the end
+                }), ("NextBlocked of a " + description + " matches the rule of each cell").c_str());
+                Expect(isSame([](Game& game) {
+                    game.Advance(37ULL);
+                    game.Advance(generationNumber - 37ULL);
+                }), ("Advance of a " + description + " matches the rule of each cell").c_str());
+            }
+
+#if defined(CYCLE)
+            // A pentadecathlon repeats every 15 generations, and Seek skips whole periods of it.
+            ofstream(folder / "Pentadecathlon.rle") << "x = 10, y = 3, rule = B3/S23\n2bo4bo$2ob4ob2o$2bo4bo!\n";
+            constexpr auto targetGeneration = 5003ULL; // not a whole number of periods
+            Game           seeker ({ 64, 64 });
+            Game           stepper({ 64, 64 });
+            for (auto game : { &seeker, &stepper }) {
+                game->ReadPatterns(ToFilePath(folder));
+                game->SetPattern(game->FindPattern(_T("Pentadecathlon")));
+            }
+            seeker.Seek(targetGeneration);
+            for (auto count = 0ULL; count < targetGeneration; count++)
+                stepper.Next();
+            Expect(seeker.GetPeriod() == 15ULL && seeker.GetGeneration() == targetGeneration && IsSame(seeker, stepper), "Seek skipping the periods matches Next");
+#endif // CYCLE
         }
+
+#if !defined(HASHLIFE) && !defined(SPARSE)
+        /// <summary>Writes, reads and restores a checkpoint, and reads files that are not valid checkpoints.</summary>
+        void CheckCheckpoints(const filesystem::path& folder)
+        {
+            const auto size = Size(300, 200);
+            Game game(size);
+            game.SetTopology(Topology::Torus);
+            game.SetRule(Rule::HighLife());
+            game.Advance(10ULL);
+
+            const auto filePath = ToFilePath(folder / "Board.checkpoint");
+            Checkpoint checkpoint;
+            Expect(game.GetCheckpoint().Write(filePath) && checkpoint.Read(filePath), "Checkpoint write and read");
+
+            Game restored(size);
+            Expect(restored.Restore(checkpoint), "Checkpoint restore");
+            Expect(restored.GetGeneration() == game.GetGeneration() && restored.GetRule() == game.GetRule() &&
+                   restored.GetTopology() == game.GetTopology() && IsSame(restored, game), "Checkpoint restores the game");
+            game    .Advance(20ULL);
+            restored.Advance(20ULL);
+            game    .Reset(true);
+            restored.Reset(true);
+            Expect(IsSame(restored, game), "Checkpoint restores the random state");
+
+            Game other({ 100, 100 });
+            const auto cells = GetCells(other);
+            Expect(!other.Restore(checkpoint) && GetCells(other) == cells, "Checkpoint of another size is rejected");
+
+            const auto isRejected = [&](Checkpoint invalid) {
+                Checkpoint read;
+                return invalid.Write(filePath) && !read.Read(filePath);
+            };
+            auto bornFromNothing = checkpoint;
+            bornFromNothing.rule = Rule(0b1001, 0b1100);
+            auto unknownTopology = checkpoint;
+            unknownTopology.topology = Topology(2);
+            auto brokenRandom = checkpoint;
+            brokenRandom.randomState = "0 1 2";
+            Expect(isRejected(bornFromNothing) && isRejected(unknownTopology) && isRejected(brokenRandom), "Checkpoint with an unsupported rule, topology or random state is rejected");
+
+            {
+                ofstream stream(filePath, ios::binary | ios::trunc);
+                stream.write(Checkpoint::magic, sizeof(Checkpoint::magic));
+            }
+            Expect(!checkpoint.Read(filePath), "Checkpoint cut short is rejected");
+        }
+#endif // !HASHLIFE && !SPARSE
     };
 }
 
-int main()
-{ Shos::LifeGame::Test::Program().Run(); }
+/// <remarks>With --check, only the regression tests are run.</remarks>
+int main(int argc, char* argv[])
+{
+    Shos::LifeGame::Test::Program program;
+    const auto isPassed = program.Check();
+    if (argc < 2 || strcmp(argv[1], "--check") != 0)
+        program.Run();
+    return isPassed ? 0 : 1;
+}
@@ -74,7 +74,11 @@ protected:
     }
 
     virtual void OnPaint(HDC deviceContextHandle) override
+#if defined(PROFILE)
+    { BoardPainter::Paint(deviceContextHandle, paintPosition, game.GetBoard(), game.GetProfiler()); }
+#else // PROFILE
     { BoardPainter::Paint(deviceContextHandle, paintPosition, game.GetBoard()); }
+#endif // PROFILE
 
 #if defined(TIMER)
     virtual void OnTimer(int timerId) override
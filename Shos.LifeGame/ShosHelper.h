@@ -5,6 +5,20 @@
 #include <string>
 #include <sstream>
 #include <vector>
+#include <string_view>
+#if defined(_WIN32)
+#if !defined(NOMINMAX)
+#define NOMINMAX
+#endif // NOMINMAX
+#include <windows.h>
+#include <tchar.h>
+#else // _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define _T(text) text
+#endif // _WIN32
 
 #if defined(UNICODE) || defined(_UNICODE)
 #define tstring std::wstring
@@ -119,6 +133,77 @@ public:
     }
 };
 
+/// <summary>A whole file mapped into memory, read-only.</summary>
+/// <remarks>A file that cannot be opened, or that is empty, gives empty text.</remarks>
+class MappedFile final
+{
+    const char* data;
+    size_t      size;
+#if defined(_WIN32)
+    HANDLE      file;
+    HANDLE      mapping;
+#endif // _WIN32
+
+public:
+    MappedFile(const tstring& filePath) : data(nullptr), size(0U)
+#if defined(_WIN32)
+        , file(INVALID_HANDLE_VALUE), mapping(nullptr)
+#endif // _WIN32
+    { Open(filePath); }
+
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile()
+    {
+#if defined(_WIN32)
+        if (data != nullptr)
+            ::UnmapViewOfFile(data);
+        if (mapping != nullptr)
+            ::CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE)
+            ::CloseHandle(file);
+#else // _WIN32
+        if (data != nullptr)
+            ::munmap(const_cast<char*>(data), size);
+#endif // _WIN32
+    }
+
+    std::string_view GetText() const
+    { return data == nullptr ? std::string_view() : std::string_view(data, size); }
+
+private:
+    void Open(const tstring& filePath)
+    {
+#if defined(_WIN32)
+        file = ::CreateFile(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        LARGE_INTEGER fileSize;
+        if (file == INVALID_HANDLE_VALUE || !::GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+            return;
+        mapping = ::CreateFileMapping(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping == nullptr)
+            return;
+        data = static_cast<const char*>(::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        if (data != nullptr)
+            size = size_t(fileSize.QuadPart);
+#else // _WIN32
+        const auto descriptor = ::open(filePath.c_str(), O_RDONLY);
+        if (descriptor < 0)
+            return;
+        struct stat status;
+        if (::fstat(descriptor, &status) == 0 && status.st_size > 0) {
+            const auto address = ::mmap(nullptr, size_t(status.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+            if (address != MAP_FAILED) {
+                ::madvise(address, size_t(status.st_size), MADV_SEQUENTIAL);
+                data = static_cast<const char*>(address);
+                size = size_t(status.st_size);
+            }
+        }
+        ::close(descriptor); // The mapping stays valid.
+#endif // _WIN32
+    }
+};
+
 class String final
 {
 public:
@@ -132,6 +217,22 @@ public:
                                                               : source.substr(start, end - start + 1);
     }
 
+    /// <summary>Takes the first line off text, without its line break and the spaces around it.</summary>
+    /// <returns>false if text is empty.</returns>
+    static bool ReadLine(std::string_view& text, std::string_view& line)
+    {
+        if (text.empty())
+            return false;
+
+        const auto end = text.find('\n');
+        line = text.substr(0U, end);
+        text = end == std::string_view::npos ? std::string_view() : text.substr(end + 1U);
+
+        const auto first = line.find_first_not_of(" \t\r");
+        line = first == std::string_view::npos ? std::string_view() : line.substr(first, line.find_last_not_of(" \t\r") - first + 1U);
+        return true;
+    }
+
     static std::string Adjust(std::string text, char character, size_t width)
     {
         if (text.length() < width)
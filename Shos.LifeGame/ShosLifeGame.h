@@ -1,25 +1,75 @@
 #pragma once
 
-//#define USEBITS // Bits enabled
+#if !defined(CONFIGURED) // A build that defines CONFIGURED chooses the optimizations below itself
+#define USEBITS // Bits enabled
 #define FAST    // Fast loops enabled
 #define MT      // Multi-threading enabled
 #define AREA    // Area enabled
+#define SIMD    // SIMD enabled (with USEBITS and FAST)
+//#define TILE    // Tiles enabled (with USEBITS and FAST, instead of AREA)
+//#define HASHLIFE // HashLife enabled
+//#define SPARSE   // Unbounded sparse universe enabled (instead of HASHLIFE)
+//#define CYCLE    // Cycle detection enabled (with USEBITS, without HASHLIFE and SPARSE)
+//#define STATISTICS // Population statistics enabled (with USEBITS and FAST, without TILE, HASHLIFE and SPARSE)
+//#define PROFILE  // Timings of the phases of a generation enabled
+//#define TRACE    // Chrome trace events of the generations and the workers enabled
+#endif // CONFIGURED
+
+#if defined(TILE) && (defined(AREA) || !defined(USEBITS) || !defined(FAST))
+#error TILE needs USEBITS and FAST, and replaces AREA.
+#endif // TILE && (AREA || !USEBITS || !FAST)
+
+#if defined(HASHLIFE) && defined(SPARSE)
+#error HASHLIFE and SPARSE cannot be enabled together.
+#endif // HASHLIFE && SPARSE
+
+#if defined(CYCLE) && (!defined(USEBITS) || defined(HASHLIFE) || defined(SPARSE))
+#error CYCLE needs USEBITS, and cannot be enabled with HASHLIFE or SPARSE.
+#endif // CYCLE && (!USEBITS || HASHLIFE || SPARSE)
+
+#if defined(STATISTICS) && (!defined(USEBITS) || !defined(FAST) || defined(TILE) || defined(HASHLIFE) || defined(SPARSE))
+#error STATISTICS needs USEBITS and FAST, and cannot be enabled with TILE, HASHLIFE or SPARSE.
+#endif // STATISTICS && (!USEBITS || !FAST || TILE || HASHLIFE || SPARSE)
 
 #include <string>
 #include <functional>
 #include <tuple>
 #if defined(MT)
 #include <thread>
+#include <atomic>
 #endif // MT
+#include <vector>
+#include <memory>
+#include <mutex>
 
 #include <random>
 #include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <charconv>
+#include <limits>
 #include <sstream>
 #include <cstdlib>
 #include <cstring>
+#include <new>
 #include <cassert>
-#include <tchar.h>
 #include "ShosHelper.h"
+#include "ShosLifeGameKernel.h"
+#include "ShosLifeGameMacrocell.h"
+#if defined(MT) && defined(KERNEL_X86)
+#include <emmintrin.h>
+#endif // MT && KERNEL_X86
+#if defined(HASHLIFE)
+#include "ShosLifeGameHashLife.h"
+#elif defined(SPARSE)
+#include "ShosLifeGameSparse.h"
+#endif // HASHLIFE
+#if defined(PROFILE)
+#include "ShosLifeGameProfiler.h"
+#endif // PROFILE
+#if defined(TRACE)
+#include "ShosLifeGameTracer.h"
+#endif // TRACE
 #if defined(_DEBUG)
 #include "ShosDebug.h"
 #endif // _DEBUG
@@ -29,7 +79,7 @@ namespace Shos::LifeGame {
 using Integer         = int          ;
 using UnsignedInteger = unsigned int ;
 using Byte            = unsigned char;
-using UnitInteger     = Byte         ;
+using UnitInteger     = std::uint64_t;
 
 class Random final
 {
@@ -42,6 +92,37 @@ public:
 
     Integer Next()
     { return engine(); }
+
+    std::string GetState() const
+    {
+        std::ostringstream stream;
+        stream << engine;
+        return stream.str();
+    }
+
+    /// <returns>false, and the state is kept, if state is not one GetState returned.</returns>
+    bool SetState(const std::string& state)
+    {
+        std::mt19937 newEngine;
+        if (!Parse(state, newEngine))
+            return false;
+        engine = newEngine;
+        return true;
+    }
+
+    static bool IsState(const std::string& state)
+    {
+        std::mt19937 newEngine;
+        return Parse(state, newEngine);
+    }
+
+private:
+    static bool Parse(const std::string& state, std::mt19937& engine)
+    {
+        std::istringstream stream(state);
+        stream >> engine;
+        return !stream.fail() && (stream >> std::ws).eof();
+    }
 };
 
 struct Size final
@@ -133,6 +214,53 @@ private:
     { return minimum <= value && value < minimum + size; }
 };
 
+/// <summary>What the cells on an edge of a board see beyond it.</summary>
+enum class Topology
+{
+    Bounded, // Dead cells
+    Torus    // The cells on the opposite edge
+};
+
+#if defined(STATISTICS)
+/// <summary>The population of a generation, the cells born and died since the generation before, and the bounds of the alive cells.</summary>
+/// <remarks>Aligned to a cache line, so that the partial statistics of the workers do not share one.</remarks>
+struct alignas(64) Statistics final
+{
+    unsigned long long population;
+    unsigned long long births;
+    unsigned long long deaths;
+    Integer            left; // the bounds [left, right) x [top, bottom), if the population is not 0
+    Integer            top;
+    Integer            right;
+    Integer            bottom;
+
+    Statistics() : population(0ULL), births(0ULL), deaths(0ULL), left(0), top(0), right(0), bottom(0)
+    {}
+
+    /// <summary>The statistics of row y.</summary>
+    Statistics(const KernelImplementation::RowCount& count, Integer y)
+        : population(count.population), births(count.births), deaths(count.deaths), left(Integer(count.left)), top(y), right(Integer(count.right)), bottom(y + 1)
+    {}
+
+    Rect GetBounds() const
+    { return Rect(Point(left, top), Point(right, bottom)); }
+
+    /// <summary>Adds the statistics of other cells.</summary>
+    void Add(const Statistics& statistics)
+    {
+        if (statistics.population != 0ULL) {
+            left   = population == 0ULL ? statistics.left   : std::min(left  , statistics.left  );
+            top    = population == 0ULL ? statistics.top    : std::min(top   , statistics.top   );
+            right  = population == 0ULL ? statistics.right  : std::max(right , statistics.right );
+            bottom = population == 0ULL ? statistics.bottom : std::max(bottom, statistics.bottom);
+        }
+        population += statistics.population;
+        births     += statistics.births;
+        deaths     += statistics.deaths;
+    }
+};
+#endif // STATISTICS
+
 #if !defined(FAST)
 class Utility final
 {
@@ -160,48 +288,87 @@ public:
 #endif // FAST
 
 #if defined(MT)
-class ThreadUtility final
+/// <summary>A fixed set of worker threads that stay alive between calls of Run.</summary>
+/// <remarks>
+/// Idle workers spin for a while after each run and then park, so that the next generation starts without creating threads.
+/// The calling thread works as worker 0.
+/// </remarks>
+class ThreadPool final
 {
+    std::vector<std::thread>                 threads;
+    const std::function<void(unsigned int)>* task;
+    std::atomic<unsigned long long>          epoch;
+    std::atomic<unsigned int>                remaining;
+    std::atomic<bool>                        stopping;
+    unsigned int                             spinCount;
+
 public:
-#if defined(AREA)
-    static void ForEach(Integer minimum, Integer maximum, std::function<void(Integer, Integer, unsigned int)> action)
+    /// <param name="workerNumber">The number of workers including the calling thread; 0 means one per hardware thread.</param>
+    /// <param name="spinCount">How many times a waiting thread polls before it parks; 0 parks at once.</param>
+    /// <remarks>Threads never spin when there are more workers than hardware threads.</remarks>
+    ThreadPool(unsigned int workerNumber = 0U, unsigned int spinCount = 1U << 14) : task(nullptr), epoch(0ULL), remaining(0U), stopping(false), spinCount(spinCount)
     {
-        const auto               hardwareConcurrency = GetHardwareConcurrency();
-        const Integer            size = maximum - minimum;
-        std::vector<std::thread> threads;
+        if (workerNumber == 0U)
+            workerNumber = GetHardwareConcurrency();
+        if (workerNumber > GetHardwareConcurrency())
+            this->spinCount = 0U;
 
-        for (auto threadIndex = 0U; threadIndex < hardwareConcurrency; threadIndex++) {
-            const auto index = threadIndex;
-            const auto begin = minimum + size * index / hardwareConcurrency;
-            const auto end   = minimum + (index == hardwareConcurrency - 1 ? size
-                                                                           : size * (index + 1) / hardwareConcurrency);
-            threads.emplace_back([=]() { action(begin, end, threadIndex); });
-        }
+        for (auto index = 1U; index < workerNumber; index++)
+            threads.emplace_back([this, index]() { Work(index); });
+    }
+
+    ~ThreadPool()
+    {
+        stopping.store(true, std::memory_order_relaxed);
+        epoch.fetch_add(1ULL, std::memory_order_release);
+        epoch.notify_all();
 
         for (auto& thread : threads)
             thread.join();
     }
-#else // AREA
-    static void ForEach(Integer minimum, Integer maximum, std::function<void(Integer, Integer)> action)
-    {
-        const auto               hardwareConcurrency = GetHardwareConcurrency();
-        const Integer            size = maximum - minimum;
-        std::vector<std::thread> threads;
 
-        for (auto threadIndex = 0U; threadIndex < hardwareConcurrency; threadIndex++) {
-            const auto index = threadIndex;
-            const auto begin = minimum + size * index / hardwareConcurrency;
-            const auto end   = minimum + (index == hardwareConcurrency - 1 ? size
-                                                                           : size * (index + 1) / hardwareConcurrency);
-            threads.emplace_back([=]() { action(begin, end); });
+    ThreadPool(const ThreadPool&)            = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned int GetWorkerNumber() const
+    { return UnsignedInteger(threads.size()) + 1U; }
+
+    /// <summary>Calls task(index) once for each worker index, and returns when all of them have returned.</summary>
+    void Run(const std::function<void(unsigned int)>& task)
+    {
+        if (threads.empty()) {
+            task(0U);
+            return;
         }
 
-        for (auto& thread : threads)
-            thread.join();
+        this->task = &task;
+        remaining.store(UnsignedInteger(threads.size()), std::memory_order_relaxed);
+        epoch.fetch_add(1ULL, std::memory_order_release);
+        epoch.notify_all();
+
+        task(0U);
+
+        Wait(remaining, [](unsigned int value) { return value == 0U; });
+    }
+
+    /// <summary>Spins, then parks, until isDone(value); a task may wait with it for other workers.</summary>
+    template <typename T, typename TIsDone>
+    T Wait(const std::atomic<T>& value, TIsDone isDone) const
+    {
+        for (auto count = 0U; count < spinCount; count++) {
+            const auto current = value.load(std::memory_order_acquire);
+            if (isDone(current))
+                return current;
+            Pause();
+        }
+        for (;;) {
+            const auto current = value.load(std::memory_order_acquire);
+            if (isDone(current))
+                return current;
+            value.wait(current, std::memory_order_acquire);
+        }
     }
 
-private:
-#endif // AREA
     static unsigned int GetHardwareConcurrency()
     {
         auto hardwareConcurrency = std::thread::hardware_concurrency();
@@ -209,278 +376,900 @@ private:
             hardwareConcurrency = 1U;
         return hardwareConcurrency;
     }
+
+private:
+    void Work(unsigned int index)
+    {
+#if defined(TRACE)
+        Tracer::SetThreadName("Worker", index);
+#endif // TRACE
+        auto lastEpoch = 0ULL;
+        for (;;) {
+            lastEpoch = Wait(epoch, [lastEpoch](unsigned long long value) { return value != lastEpoch; });
+            if (stopping.load(std::memory_order_relaxed))
+                return;
+
+            (*task)(index);
+
+            if (remaining.fetch_sub(1U, std::memory_order_acq_rel) == 1U)
+                remaining.notify_one();
+        }
+    }
+
+    static void Pause()
+    {
+#if defined(KERNEL_X86)
+        _mm_pause();
+#else // KERNEL_X86
+        std::this_thread::yield();
+#endif // KERNEL_X86
+    }
+};
+
+class ThreadUtility final
+{
+public:
+    static void ForEach(ThreadPool& threadPool, Integer minimum, Integer maximum, std::function<void(Integer, Integer, unsigned int)> action)
+    {
+        const auto    workerNumber = threadPool.GetWorkerNumber();
+        const Integer size         = maximum - minimum;
+
+        threadPool.Run([&](unsigned int index) {
+            const auto begin = minimum + size * index / workerNumber;
+            const auto end   = minimum + (index == workerNumber - 1 ? size
+                                                                    : size * (index + 1) / workerNumber);
+#if defined(TRACE)
+            const Tracer::Span span("ForEach", "rows", end - begin);
+#endif // TRACE
+            action(begin, end, index);
+        });
+    }
+
+    static void ForEach(ThreadPool& threadPool, Integer minimum, Integer maximum, std::function<void(Integer, Integer)> action)
+    {
+        const auto    workerNumber = threadPool.GetWorkerNumber();
+        const Integer size         = maximum - minimum;
+
+        threadPool.Run([&](unsigned int index) {
+            const auto begin = minimum + size * index / workerNumber;
+            const auto end   = minimum + (index == workerNumber - 1 ? size
+                                                                    : size * (index + 1) / workerNumber);
+#if defined(TRACE)
+            const Tracer::Span span("ForEach", "rows", end - begin);
+#endif // TRACE
+            action(begin, end);
+        });
+    }
 };
 #endif // MT
 
+/// <summary>The ways to turn a pattern: the rotations are clockwise, and the reflections are about the axis named.</summary>
+enum class Orientation
+{
+    Identity, Rotate90, Rotate180, Rotate270, FlipHorizontal, FlipVertical, Transpose, AntiTranspose
+};
+
+/// <summary>An initial pattern, its cells packed into rows of 64-bit units.</summary>
 class Pattern final
 {
-    const char            alive = '*';
-    const tstring         name;
-    const std::string     pattern;
-    const UnsignedInteger width;
+    static constexpr UnsignedInteger bitNumber = sizeof(UnitInteger) * 8;
+
+    const tstring                  name;
+    const Size                     size;
+    const std::vector<UnitInteger> bits;
+    const Rule                     rule;
 
 public:
     Size GetSize() const
-    {
-        if (width == 0)
-            return Size();
-
-        auto size = Size{ Integer(width), Integer(pattern.length() / width) };
-        if (pattern.length() % width != 0)
-            size.cy++;
-        return size;
-    }
+    { return size; }
 
     const tstring& GetName() const
     { return name; }
 
-    Pattern(const tstring& name, const std::string& pattern, UnsignedInteger width) : name(name), pattern(pattern), width(width)
-    {}
+    /// <remarks>The rule of the RLE header, or B3/S23.</remarks>
+    const Rule& GetRule() const
+    { return rule; }
+
+    /// <param name="bits">size.cy rows of GetUnitNumberX(size.cx) units; bit n of a unit is the n-th cell from the left.</param>
+    Pattern(const tstring& name, const Size& size, std::vector<UnitInteger>&& bits, const Rule& rule = Rule()) : name(name), size(size), bits(std::move(bits)), rule(rule)
+    { assert(this->bits.size() == GetUnitNumberX(size.cx) * UnsignedInteger(size.cy)); }
+
+    bool Get(const Point& point) const
+    { return (GetRow(point.y)[UnsignedInteger(point.x) / bitNumber] >> (UnsignedInteger(point.x) % bitNumber) & 1U) != 0U; }
 
+    /// <remarks>index counts the cells row by row.</remarks>
     bool operator[](size_t index) const
-    { return pattern[index] == alive; }
+    { return Get(Point(Integer(index % size_t(size.cx)), Integer(index / size_t(size.cx)))); }
+
+    const UnitInteger* GetRow(Integer y) const
+    { return bits.data() + GetUnitNumberX(size.cx) * UnsignedInteger(y); }
+
+    static UnsignedInteger GetUnitNumberX(Integer width)
+    { return (UnsignedInteger(width) + bitNumber - 1U) / bitNumber; }
+
+    /// <summary>Calls action with each alive cell, a row at a time.</summary>
+    void ForEachAlive(std::function<void(const Point&)> action) const
+    {
+        const auto unitNumberX = GetUnitNumberX(size.cx);
+        for (auto y = 0; y < size.cy; y++) {
+            const auto row = GetRow(y);
+            for (auto index = 0U; index < unitNumberX; index++) {
+                for (auto unit = row[index]; unit != 0U; unit &= unit - 1U)
+                    action(Point(Integer(index * bitNumber) + std::countr_zero(unit), y));
+            }
+        }
+    }
+
+    /// <summary>A copy of the pattern turned to orientation.</summary>
+    /// <remarks>Only the alive cells are visited.</remarks>
+    Pattern Transform(Orientation orientation) const
+    {
+        const auto isSwapped = orientation == Orientation::Rotate90  || orientation == Orientation::Rotate270 ||
+                               orientation == Orientation::Transpose || orientation == Orientation::AntiTranspose;
+        const auto newSize   = isSwapped ? Size(size.cy, size.cx) : size;
+
+        const auto               unitNumberX = GetUnitNumberX(newSize.cx);
+        std::vector<UnitInteger> newBits(unitNumberX * UnsignedInteger(newSize.cy));
+        ForEachAlive([&](const Point& point) {
+            const auto newPoint = Transform(orientation, point);
+            Fill(&newBits[unitNumberX * UnsignedInteger(newPoint.y)], UnsignedInteger(newPoint.x), UnsignedInteger(newPoint.x) + 1U);
+        });
+        return Pattern(name, newSize, std::move(newBits), rule);
+    }
+
+    /// <summary>Makes the cells [begin, end) of row alive, a unit at a time.</summary>
+    static void Fill(UnitInteger* row, UnsignedInteger begin, UnsignedInteger end)
+    {
+        for (auto index = begin / bitNumber; index * bitNumber < end; index++) {
+            const auto low  = std::max(begin, index * bitNumber) - index * bitNumber;
+            const auto high = std::min(end  , (index + 1U) * bitNumber) - index * bitNumber;
+            row[index] |= (high == bitNumber ? ~UnitInteger(0) : (UnitInteger(1) << high) - 1U) & ~((UnitInteger(1) << low) - 1U);
+        }
+    }
+
+private:
+    Point Transform(Orientation orientation, const Point& point) const
+    {
+        const auto right  = size.cx - 1;
+        const auto bottom = size.cy - 1;
+        switch (orientation) {
+        case Orientation::Rotate90      : return Point(bottom - point.y, point.x          );
+        case Orientation::Rotate180     : return Point(right  - point.x, bottom - point.y );
+        case Orientation::Rotate270     : return Point(point.y         , right  - point.x );
+        case Orientation::FlipHorizontal: return Point(right  - point.x, point.y          );
+        case Orientation::FlipVertical  : return Point(point.x         , bottom - point.y );
+        case Orientation::Transpose     : return Point(point.y         , point.x          );
+        case Orientation::AntiTranspose : return Point(bottom - point.y, right  - point.x );
+        default                         : return point;
+        }
+    }
 };
 
+/// <summary>The catalog of the pattern files in a folder.</summary>
+/// <remarks>
+/// Building the catalog reads only the names and headers of the files. A pattern is decoded when it is first used,
+/// or in the background with MT, and the cacheSize patterns used last are kept decoded.
+/// </remarks>
 class PatternSet final
 {
-    std::vector<Pattern> patterns;
-
 public:
-    size_t GetSize() const
-    { return patterns.size(); }
+    static constexpr size_t cacheSize = 16U;
 
-    const Pattern& operator[](size_t index) const
-    { return patterns[index]; }
+    enum class Format
+    {
+        Life, Rle, Macrocell
+    };
 
-    PatternSet()
+    /// <summary>What the catalog knows of a pattern before decoding it.</summary>
+    struct Header
     {
-        const auto folderName = _T(".\\CellData");
+        tstring filePath;
+        tstring name;
+        Size    size; // empty for a Life 1.05 or Macrocell file, which has no size in its header
+        Rule    rule;
+        Format  format;
+    };
+
+private:
+    using Entry = std::pair<size_t, std::shared_ptr<const Pattern>>;
 
-        std::vector<Pattern> patterns5;
-        Pattern5::ReadFromFolder(folderName, patterns5);
-        Helper::Connect<std::vector<Pattern>>(patterns, patterns5);
+    static constexpr size_t maximumUnitNumber = size_t(1) << 26; // 512 MiB of cells, the largest pattern decoded for a board
 
-        std::vector<Pattern> patternsRle;
-        RlePattern::ReadFromFolder(folderName, patternsRle);
-        Helper::Connect<std::vector<Pattern>>(patterns, patternsRle);
-    }
+    std::vector<Header> headers;
+    std::vector<Entry>  cache; // the pattern used last first
+    std::mutex          cacheMutex;
+#if defined(MT)
+    std::jthread        preloader;
+#endif // MT
 
-private:
-    class Pattern5 final
+public:
+    size_t GetSize() const
+    { return headers.size(); }
+
+    const Header& GetHeader(size_t index) const
+    { return headers[index]; }
+
+    /// <summary>Gets a pattern from the cache, or decodes it.</summary>
+    std::shared_ptr<const Pattern> Get(size_t index)
     {
-    public:
-        static void ReadFromFolder(tstring folderName, std::vector<Pattern>& patterns)
         {
-            patterns.clear();
+            std::lock_guard<std::mutex> lock(cacheMutex);
+            const auto entry = Find(index);
+            if (entry != cache.end()) {
+                std::rotate(cache.begin(), entry, entry + 1);
+                return cache.front().second;
+            }
+        }
 
-            const auto           extension5 = ".lif";
-            std::vector<tstring> filePaths;
-            Shos::File::GetFilePaths(folderName, filePaths, extension5);
+        auto pattern = Decode(index);
 
-            Helper::Map<std::vector<tstring>, std::vector<Pattern>, tstring, Pattern>(filePaths, patterns, [&](tstring filePath) { return Read(filePath); });
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        const auto entry = Find(index); // the preloader may have decoded it meanwhile
+        if (entry != cache.end()) {
+            std::rotate(cache.begin(), entry, entry + 1);
+        } else {
+            if (cache.size() == cacheSize)
+                cache.pop_back();
+            cache.insert(cache.begin(), { index, std::move(pattern) });
         }
+        return cache.front().second;
+    }
 
-        static std::string Adjust(std::string text, size_t width)
-        {
-            const auto character = '.';
-            return String::Adjust(text, character, width);
-        }
+    /// <summary>Reads the tree of a Macrocell pattern as it is, without decoding its cells.</summary>
+    /// <returns>false if the pattern is not a Macrocell file or cannot be parsed.</returns>
+    bool Get(size_t index, Macrocell& macrocell) const
+    { return headers[index].format == Format::Macrocell && MacrocellPattern::Read(headers[index].filePath, macrocell); }
 
-    private:
-        static Pattern Read(tstring filePath)
-        {
-            std::vector<std::string> lines;
-            Shos::File::Read(filePath, lines);
+    PatternSet(const tstring& folderName = _T("CellData"))
+    { Read(folderName); }
 
-            std::vector<std::string> trimedLines;
-            Helper::Map<std::vector<std::string>, std::vector<std::string>, std::string, std::string>(lines, trimedLines, [](std::string text) { return String::Trim(text); });
+    PatternSet(const PatternSet&)            = delete;
+    PatternSet& operator=(const PatternSet&) = delete;
 
-            std::vector<std::string> filteredLines;
-            Helper::Filter<std::vector<std::string>, std::string>(trimedLines, filteredLines, [](const std::string& text) { return !text.starts_with('#'); });
+    /// <summary>Replaces the catalog with the pattern files in folderName: the Life 1.05 files, the RLE files, then the Macrocell files.</summary>
+    void Read(const tstring& folderName)
+    {
+#if defined(MT)
+        preloader = std::jthread(); // stops and joins the preloader of the last folder
+#endif // MT
+        cache  .clear();
+        headers.clear();
+        Pattern5        ::ReadHeaders(folderName, headers);
+        RlePattern      ::ReadHeaders(folderName, headers);
+        MacrocellPattern::ReadHeaders(folderName, headers);
 
-            if (filteredLines.size() == 0)
-                return Pattern(_T(""), "", 0U);
+#if defined(MT)
+        preloader = std::jthread([this](std::stop_token stopToken) { Preload(stopToken); });
+#endif // MT
+    }
 
-            const auto width = Helper::Maximum<std::vector<std::string>, std::string, UnsignedInteger>(filteredLines, [](const std::string& text) { return UnsignedInteger(text.length()); });
+private:
+    std::vector<Entry>::iterator Find(size_t index)
+    { return std::find_if(cache.begin(), cache.end(), [index](const Entry& entry) { return entry.first == index; }); }
 
-            std::vector<std::string> ajustedLines;
-            Helper::Map<std::vector<std::string>, std::vector<std::string>, std::string, std::string>(filteredLines, ajustedLines, [&](std::string text) { return Adjust(text, width); });
+    std::shared_ptr<const Pattern> Decode(size_t index) const
+    {
+#if defined(TRACE)
+        const Tracer::Span span("LoadPattern", "index", Tracer::Argument(index));
+#endif // TRACE
+        const auto& header = headers[index];
+        switch (header.format) {
+        case Format::Rle      : return std::make_shared<const Pattern>(RlePattern      ::Read(header.filePath));
+        case Format::Macrocell: return std::make_shared<const Pattern>(MacrocellPattern::Read(header.filePath));
+        default               : return std::make_shared<const Pattern>(Pattern5        ::Read(header.filePath));
+        }
+    }
 
-            std::string pattern = Helper::Connect(ajustedLines);
+#if defined(MT)
+    /// <summary>Decodes the first patterns into the free places of the cache, so that they never push out a pattern in use.</summary>
+    void Preload(std::stop_token stopToken)
+    {
+        for (size_t index = 0U; index < std::min(headers.size(), cacheSize) && !stopToken.stop_requested(); index++) {
+            {
+                std::lock_guard<std::mutex> lock(cacheMutex);
+                if (Find(index) != cache.end())
+                    continue;
+            }
+            auto pattern = Decode(index);
 
-            return Pattern(Shos::File::GetStem(filePath), pattern, width);
+            std::lock_guard<std::mutex> lock(cacheMutex);
+            if (cache.size() < cacheSize && Find(index) == cache.end())
+                cache.push_back({ index, std::move(pattern) });
         }
-    };
+    }
+#endif // MT
 
-    class RlePattern final
+    class Pattern5 final
     {
     public:
-        static void ReadFromFolder(tstring folderName, std::vector<Pattern>& patterns)
+        /// <summary>Adds the headers of the Life 1.05 files in folderName, reading only the comment lines before the first row.</summary>
+        static void ReadHeaders(const tstring& folderName, std::vector<Header>& headers)
         {
-            patterns.clear();
-
-            const auto           extensionRle = ".rle";
             std::vector<tstring> filePaths;
-            Shos::File::GetFilePaths(folderName, filePaths, extensionRle);
-
-            Helper::Map<std::vector<tstring>, std::vector<Pattern>, tstring, Pattern>(filePaths, patterns, [&](tstring filePath) { return Read(filePath); });
+            Shos::File::GetFilePaths(folderName, filePaths, ".lif");
+
+            for (const auto& filePath : filePaths) {
+                const MappedFile file(filePath);
+                Rule             rule;
+                std::string_view line;
+                for (auto text = file.GetText(); String::ReadLine(text, line) && line.starts_with('#'); ) {
+                    if (line.starts_with("#R"))
+                        Rule::Parse(std::string(line.substr(2U)), rule);
+                }
+                headers.push_back({ filePath, Shos::File::GetStem(filePath), Size(), rule, Format::Life });
+            }
         }
 
-    private:
+        /// <remarks>
+        /// Each line that is not a comment is a row of '*' (alive) and '.' (dead); "#R 23/3" gives the rule.
+        /// The mapped file is read twice, for the width and for the cells, without copying a line.
+        /// A file with a rule that is not supported gives the empty pattern, rather than one run under B3/S23.
+        /// </remarks>
         static Pattern Read(tstring filePath)
         {
-            std::vector<std::string> lines;
-            Shos::File::Read(filePath, lines);
-
-            std::vector<std::string> trimedLines;
-            Helper::Map<std::vector<std::string>, std::vector<std::string>, std::string, std::string>(lines, trimedLines, [](std::string text) { return String::Trim(text); });
-
-            std::vector<std::string> filteredLines;
-            Helper::Filter<std::vector<std::string>, std::string>(trimedLines, filteredLines, [](const std::string& text) { return !text.empty() && !text.starts_with('#'); });
-
-            if (filteredLines.size() == 0)
-                return Pattern(_T(""), "", 0U);
-
-            const auto rule = filteredLines[0];
-            auto [width, height] = GetRleSize(rule);
-
-            std::vector<std::string> patternLines{ filteredLines.begin() + 1, filteredLines.end() };
-
-            std::string pattern = Helper::Connect(patternLines);
-            pattern = RleToPattern(pattern, width, height);
+            const MappedFile file(filePath);
+
+            Rule             rule;
+            UnsignedInteger  width  = 0U;
+            Integer          height = 0;
+            std::string_view line;
+            for (auto text = file.GetText(); String::ReadLine(text, line); ) {
+                if (line.starts_with("#R")) {
+                    if (!Rule::Parse(std::string(line.substr(2U)), rule))
+                        return Pattern(_T(""), Size(), {});
+                } else if (!line.starts_with('#')) {
+                    width = std::max(width, UnsignedInteger(line.length()));
+                    height++;
+                }
+            }
+            if (height == 0)
+                return Pattern(_T(""), Size(), {});
+
+            const auto               unitNumberX = Pattern::GetUnitNumberX(Integer(width));
+            std::vector<UnitInteger> bits(unitNumberX * UnsignedInteger(height));
+            auto                     row         = bits.data();
+            for (auto text = file.GetText(); String::ReadLine(text, line); ) {
+                if (line.starts_with('#'))
+                    continue;
+                for (auto x = line.find('*'); x != std::string_view::npos; x = line.find('*', x + 1U))
+                    Pattern::Fill(row, UnsignedInteger(x), UnsignedInteger(x) + 1U);
+                row += unitNumberX;
+            }
+            return Pattern(Shos::File::GetStem(filePath), Size(Integer(width), height), std::move(bits), rule);
+        }
+    };
 
-            return Pattern(Shos::File::GetStem(filePath), pattern, width);
+    class RlePattern final
+    {
+    public:
+        /// <summary>Adds the headers of the RLE files in folderName, reading only the lines up to the header line.</summary>
+        static void ReadHeaders(const tstring& folderName, std::vector<Header>& headers)
+        {
+            std::vector<tstring> filePaths;
+            Shos::File::GetFilePaths(folderName, filePaths, ".rle");
+
+            for (const auto& filePath : filePaths) {
+                const MappedFile file(filePath);
+                auto             text   = file.GetText();
+                std::string_view line;
+                UnsignedInteger  width  = 0U;
+                UnsignedInteger  height = 0U;
+                Rule             rule;
+                if (!ReadHeader(text, line) || !GetRleHeader(std::string(line), width, height, rule))
+                    width = height = 0U;
+                headers.push_back({ filePath, Shos::File::GetStem(filePath), Size(Integer(width), Integer(height)), rule, Format::Rle });
+            }
         }
 
-        static std::string RleToPattern(std::string rlePattern, UnsignedInteger width, UnsignedInteger height)
+        /// <remarks>
+        /// One pass over the mapped file: each run of alive cells is filled into its row a unit at a time,
+        /// so the time is linear in the size of the file and the number of units, and no line is copied.
+        /// Cells beyond the width and rows beyond the height of the header are dropped.
+        /// A header that GetRleHeader rejects, or with no room for cells, gives the empty pattern.
+        /// </remarks>
+        static Pattern Read(tstring filePath)
         {
-            std::string pattern;
-            std::string partPattern;
-            size_t      count = 0U;
-            for (size_t index = 0U; index < rlePattern.length(); index++) {
-                const auto  character = std::tolower(rlePattern[index]);
-                if (std::isdigit(character)) {
-                    count = GetRleCount(rlePattern, index);
-                } else {
-                    switch (character) {
+            const MappedFile file(filePath);
+            auto             text = file.GetText();
+
+            std::string_view line;
+            UnsignedInteger  width  = 0U;
+            UnsignedInteger  height = 0U;
+            Rule             rule;
+            if (!ReadHeader(text, line) || !GetRleHeader(std::string(line), width, height, rule) || width == 0U || height == 0U)
+                return Pattern(_T(""), Size(), {});
+
+            const auto               unitNumberX = Pattern::GetUnitNumberX(Integer(width));
+            std::vector<UnitInteger> bits(unitNumberX * size_t(height));
+
+            // A run longer than limit does what one of limit cells does, so x + run cannot wrap.
+            const auto      limit = std::max(width, height);
+            UnsignedInteger x     = 0U;
+            UnsignedInteger y     = 0U;
+            UnsignedInteger count = 0U; // a count may go on in the next line
+            for (auto end = false; !end && y < height && String::ReadLine(text, line); ) {
+                if (line.starts_with('#'))
+                    continue;
+
+                for (const auto character : line) {
+                    if ('0' <= character && character <= '9') {
+                        count = UnsignedInteger(std::min(std::uint64_t(count) * 10U + std::uint64_t(character - '0'), std::uint64_t(limit)));
+                        continue;
+                    }
+                    const auto run = count == 0U ? 1U : count;
+                    switch (std::tolower(static_cast<unsigned char>(character))) {
                     case 'b':
-                        partPattern.append(count == 0U ? 1U : count, '.');
+                        x = std::min(x + run, width);
                         break;
                     case 'o':
-                        partPattern.append(count == 0U ? 1U : count, '*');
+                        if (x < width)
+                            Pattern::Fill(&bits[unitNumberX * y], x, std::min(x + run, width));
+                        x = std::min(x + run, width);
                         break;
                     case '$':
-                        AppendPartPattern(partPattern, width, pattern);
-                        partPattern.clear();
+                        x  = 0U;
+                        y += run;
                         break;
                     case '!':
-                        AppendPartPattern(partPattern, width, pattern);
-                        return pattern;
+                        end = true;
+                        break;
+                    case ' ': case '\t':
+                        continue;
                     }
                     count = 0U;
+                    if (end || y >= height)
+                        break;
                 }
             }
-            return pattern;
+            return Pattern(Shos::File::GetStem(filePath), Size(Integer(width), Integer(height)), std::move(bits), rule);
         }
 
-        static void AppendPartPattern(std::string& partPattern, UnsignedInteger width, std::string& pattern)
+    private:
+        /// <summary>Takes the lines off text up to the header line, the first one that is neither empty nor a comment.</summary>
+        static bool ReadHeader(std::string_view& text, std::string_view& line)
         {
-            if (partPattern.length() < width)
-                pattern.append(Pattern5::Adjust(partPattern, width));
-            else if (partPattern.length() > width)
-                pattern.append(partPattern.substr(0, width));
-            else
-                pattern.append(partPattern);
+            while (String::ReadLine(text, line)) {
+                if (!line.empty() && !line.starts_with('#'))
+                    return true;
+            }
+            return false;
         }
 
-        static size_t GetRleCount(std::string rlePattern, size_t& index)
+        /// <summary>Parses "x = 3, y = 3, rule = B3/S23"; with no rule, the rule is B3/S23.</summary>
+        /// <returns>false if a size is not a number, is negative, or makes a pattern larger than maximumUnitNumber units, or if the rule is not supported.</returns>
+        static bool GetRleHeader(std::string header, UnsignedInteger& width, UnsignedInteger& height, Rule& rule)
         {
-            size_t count = 0U;
-            size_t number = 0U;
-            for (; index < rlePattern.length(); number++) {
-                const auto character = rlePattern[index + number];
-                if (std::isdigit(character)) {
-                    count *= 10;
-                    count += character - '0';
-                } else {
-                    break;
+            header.erase(std::remove_if(header.begin(), header.end(), ::isspace), header.end());
+
+            const auto getSize = [](const std::string& text, UnsignedInteger& size) {
+                std::int64_t value = 0;
+                const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+                if (error != std::errc() || end != text.data() + text.size() || value < 0 || value > std::numeric_limits<Integer>::max())
+                    return false;
+                size = UnsignedInteger(value);
+                return true;
+            };
+
+            for (const auto& token : String::Split(header, ',')) {
+                const auto lowerToken = String::ToLower(token);
+                if (lowerToken.starts_with("x=")) {
+                    if (!getSize(token.substr(2), width))
+                        return false;
+                } else if (lowerToken.starts_with("y=")) {
+                    if (!getSize(token.substr(2), height))
+                        return false;
+                } else if (lowerToken.starts_with("rule=")) {
+                    if (!Rule::Parse(token.substr(5), rule))
+                        return false;
                 }
             }
-            if (number > 0U)
-                index += number - 1;
-            return count;
+            return Pattern::GetUnitNumberX(Integer(width)) * size_t(height) <= maximumUnitNumber;
         }
+    };
 
-        static std::tuple<UnsignedInteger, UnsignedInteger> GetRleSize(std::string rule)
-        {
-            rule.erase(std::remove_if(rule.begin(), rule.end(), ::isspace), rule.end());
+    class MacrocellPattern final
+    {
+        static constexpr UnsignedInteger bitNumber = sizeof(UnitInteger) * 8;
 
-            const auto tokens = String::Split(rule, ',');
-            std::vector<std::string> trimedTokens;
+    public:
+        /// <summary>Adds the headers of the Macrocell files in folderName, reading only the lines before the first node.</summary>
+        static void ReadHeaders(const tstring& folderName, std::vector<Header>& headers)
+        {
+            std::vector<tstring> filePaths;
+            Shos::File::GetFilePaths(folderName, filePaths, ".mc");
+
+            for (const auto& filePath : filePaths) {
+                const MappedFile file(filePath);
+                Rule             rule;
+                std::string_view line;
+                for (auto text = file.GetText(); String::ReadLine(text, line) && (line.starts_with('[') || line.starts_with('#')); ) {
+                    if (line.starts_with("#R"))
+                        Rule::Parse(std::string(line.substr(2U)), rule);
+                }
+                headers.push_back({ filePath, Shos::File::GetStem(filePath), Size(), rule, Format::Macrocell });
+            }
+        }
 
-            UnsignedInteger width = 0U;
-            UnsignedInteger height = 0U;
+        /// <returns>false if the file cannot be parsed.</returns>
+        static bool Read(const tstring& filePath, Macrocell& macrocell)
+        {
+            const MappedFile file(filePath);
+            return macrocell.Read(file.GetText());
+        }
 
-            try {
-                for (const auto& token : tokens) {
-                    const auto lowerToken = String::ToLower(token);
-                    if (lowerToken.starts_with("x="))
-                        width = std::stoi(token.substr(2));
-                    else if (lowerToken.starts_with("y="))
-                        height = std::stoi(token.substr(2));
+        /// <summary>Decodes the bounds of the alive cells of the tree into rows of units.</summary>
+        /// <remarks>
+        /// Each row of 8 cells of a leaf is shifted into at most two units, and empty subtrees are never visited.
+        /// A pattern that could not be on a board, larger than maximumUnitNumber units, is empty; HashLife reads the tree itself.
+        /// </remarks>
+        static Pattern Read(tstring filePath)
+        {
+            Macrocell macrocell;
+            if (!Read(filePath, macrocell))
+                return Pattern(_T(""), Size(), {});
+
+            const auto bounds = macrocell.GetBounds();
+            const auto width  = bounds.right  - bounds.left;
+            const auto height = bounds.bottom - bounds.top;
+            if (bounds.IsEmpty() || width > std::numeric_limits<Integer>::max() || height > std::numeric_limits<Integer>::max() ||
+                Macrocell::Coordinate(Pattern::GetUnitNumberX(Integer(width))) * height > Macrocell::Coordinate(maximumUnitNumber))
+                return Pattern(_T(""), Size(), {});
+
+            const auto               unitNumberX = Pattern::GetUnitNumberX(Integer(width));
+            std::vector<UnitInteger> bits(unitNumberX * size_t(height));
+            macrocell.ForEachLeaf(bounds, [&](Macrocell::Coordinate left, Macrocell::Coordinate top, Macrocell::Leaf leaf) {
+                for (auto y = 0; y < 8; y++) {
+                    auto unit = (leaf >> (y * 8)) & 0xffU;
+                    if (unit == 0U)
+                        continue; // the alive cells, and so this row, are in bounds
+
+                    auto x = left - bounds.left;
+                    if (x < 0) {
+                        unit >>= -x;
+                        x      = 0;
+                    }
+                    const auto row   = &bits[unitNumberX * size_t(top + y - bounds.top)];
+                    const auto index = UnsignedInteger(x) / bitNumber;
+                    const auto shift = UnsignedInteger(x) % bitNumber;
+                    row[index] |= unit << shift;
+                    if (shift + 8U > bitNumber && index + 1U < unitNumberX)
+                        row[index + 1U] |= unit >> (bitNumber - shift);
                 }
-            } catch (const std::exception&) {
-            }
-            return { width, height };
+            });
+            return Pattern(Shos::File::GetStem(filePath), Size(Integer(width), Integer(height)), std::move(bits), macrocell.GetRule());
         }
     };
 };
 
-class BitCellSet
+/// <summary>Writes rows of cells in the RLE and Life 1.05 formats straight to a stream, finding the runs a unit of 64 cells at a time.</summary>
+/// <remarks>
+/// getRow(y) is row y of units, bit n of which is the n-th cell from the left, as in Pattern::GetRow and BitCellSet::GetBits.
+/// Only the bounds are read, and nothing is buffered beyond the stream, so a board of any size is written in constant memory.
+/// </remarks>
+class PatternWriter final
 {
-    const Size      size;
-    UnsignedInteger unitNumberX;
-    UnitInteger*    cells;
-
-#if defined(AREA)
-    Rect            area;
-#endif // AREA
+    static constexpr Integer bitNumber    = Integer(sizeof(UnitInteger) * 8);
+    static constexpr size_t  maximumWidth = 70U; // of an RLE line
 
 public:
-    Size GetSize() const
-    { return size; }
+    /// <summary>The smallest rectangle with the alive cells in area, which is in [0, width).</summary>
+    template <typename TGetRow>
+    static Rect GetBounds(TGetRow getRow, const Rect& area, Integer width)
+    {
+        const auto areaRightBottom = area.RightBottom();
+        const auto lastUnitMask    = width % bitNumber == 0 ? ~UnitInteger(0) : (UnitInteger(1) << (width % bitNumber)) - 1U;
+        const auto lastIndex       = (width - 1) / bitNumber;
+        auto       left = width, top = areaRightBottom.y, right = 0, bottom = 0;
+        for (auto y = area.leftTop.y; y < areaRightBottom.y; y++) {
+            const auto row = getRow(y);
+            for (auto index = area.leftTop.x / bitNumber; index * bitNumber < areaRightBottom.x; index++) {
+                const auto unit = index == lastIndex ? row[index] & lastUnitMask : row[index];
+                if (unit == 0U)
+                    continue;
+                left   = std::min(left , index * bitNumber + std::countr_zero(unit));
+                right  = std::max(right, index * bitNumber + bitNumber - std::countl_zero(unit));
+                top    = std::min(top  , y);
+                bottom = y + 1;
+            }
+        }
+        return left < right ? Rect(Point(left, top), Point(right, bottom)) : Rect(Point(), Size());
+    }
 
-    Rect GetArea() const
-#if defined(AREA)
-    { return area; }
+    template <typename TGetRow>
+    static void WriteRle(std::ostream& stream, TGetRow getRow, const Rect& bounds, const Rule& rule)
+    {
+        stream << "x = " << bounds.size.cx << ", y = " << bounds.size.cy << ", rule = " << rule.ToString() << '\n';
+
+        const auto buffer = stream.rdbuf(); // without a sentry for each run
+        size_t     column = 0U;
+        const auto add    = [&](Integer count, char tag) {
+            char token[16];
+            auto end = count > 1 ? std::to_chars(token, token + sizeof(token) - 1U, count).ptr : token;
+            *end++   = tag;
+
+            const auto length = size_t(end - token);
+            if (column + length > maximumWidth) {
+                buffer->sputc('\n');
+                column = 0U;
+            }
+            buffer->sputn(token, std::streamsize(length));
+            column += length;
+        };
+
+        const auto rightBottom = bounds.RightBottom();
+        Integer    rowCount    = 0; // the ends of rows not written yet
+        for (auto y = bounds.leftTop.y; y < rightBottom.y; y++, rowCount++) {
+            const auto row = getRow(y);
+            for (auto x = bounds.leftTop.x; ; ) {
+                const auto begin = Find(row, x, rightBottom.x, true);
+                if (begin == rightBottom.x)
+                    break;
+                const auto end = Find(row, begin, rightBottom.x, false);
+                if (rowCount > 0) {
+                    add(rowCount, '$');
+                    rowCount = 0;
+                }
+                if (begin > x)
+                    add(begin - x, 'b');
+                add(end - begin, 'o');
+                x = end;
+            }
+        }
+        add(1, '!');
+        stream << '\n';
+    }
 
-    static Rect GetDefaultArea(const Rect& rect)
-    { return Rect(Point(rect.leftTop.x + std::max(0, rect.size.cx / 2 - 1), rect.leftTop.y + std::max(0, rect.size.cy / 2 - 1)), Size(std::min(rect.size.cx, 3), std::min(rect.size.cy, 3))); }
+    /// <remarks>A row with no alive cell is written as ".", and the dead cells after the last alive one in a row are dropped.</remarks>
+    template <typename TGetRow>
+    static void WriteLife(std::ostream& stream, TGetRow getRow, const Rect& bounds, const Rule& rule)
+    {
+        stream << "#Life 1.05\n#R " << rule.ToString() << '\n';
+
+        const auto rightBottom = bounds.RightBottom();
+        const auto output      = std::ostreambuf_iterator<char>(stream);
+        for (auto y = bounds.leftTop.y; y < rightBottom.y; y++) {
+            const auto row = getRow(y);
+            auto       x   = bounds.leftTop.x;
+            for (auto begin = Find(row, x, rightBottom.x, true); begin < rightBottom.x; begin = Find(row, x, rightBottom.x, true)) {
+                const auto end = Find(row, begin, rightBottom.x, false);
+                std::fill_n(output, begin - x  , '.');
+                std::fill_n(output, end - begin, '*');
+                x = end;
+            }
+            stream << (x == bounds.leftTop.x ? ".\n" : "\n");
+        }
+    }
 
-#if defined(MT)
-    void SetArea(const Rect& newArea)
-    { area = newArea; }
-#endif // MT
+    static void WriteRle(std::ostream& stream, const Pattern& pattern)
+    { WriteRle(stream, [&](Integer y) { return pattern.GetRow(y); }, Rect(Point(), pattern.GetSize()), pattern.GetRule()); }
 
-#else // AREA
-    { return GetRect(); }
-#endif // AREA
+    static void WriteLife(std::ostream& stream, const Pattern& pattern)
+    { WriteLife(stream, [&](Integer y) { return pattern.GetRow(y); }, Rect(Point(), pattern.GetSize()), pattern.GetRule()); }
 
-#if defined(AREA)
-#endif // AREA
+private:
+    /// <returns>The first cell in [x, end) of row that is alive (or dead), or end.</returns>
+    static Integer Find(const UnitInteger* row, Integer x, Integer end, bool alive)
+    {
+        while (x < end) {
+            const auto unit = (alive ? row[x / bitNumber] : ~row[x / bitNumber]) >> (x % bitNumber);
+            if (unit != 0U)
+                return std::min(end, x + std::countr_zero(unit));
+            x = (x / bitNumber + 1) * bitNumber;
+        }
+        return end;
+    }
+};
 
-    UnitInteger* GetBits() const
-    { return cells; }
+#if defined(TILE)
+/// <summary>Which tiles of 64x64 cells changed in the last two generations, and which have to be computed in the next one.</summary>
+/// <remarks>
+/// A tile is active if it or one of its eight neighbors differs from two generations before. Any other tile is frozen:
+/// its neighborhood is the one of two generations before, so its next state is the one the other board still holds,
+/// and still lifes and blinkers are not computed again until a neighboring tile changes.
+/// Each row of tiles is a bitmap of units, bit n of a unit being the n-th tile from the left.
+/// </remarks>
+class TileSet final
+{
+public:
+    static constexpr Integer tileSize = sizeof(UnitInteger) * 8;
 
-    /// <remarks>size.cx must be a multiple of 8.</remarks>
-    BitCellSet(const Size& size) : size(size)
-#if defined(AREA)
-        , area(GetDefaultArea(Rect(Point(), size)))
-#endif // AREA
-    { Initialize(); }
+private:
+    const Size               tileNumber;
+    const UnsignedInteger    unitNumberX;
+    const UnitInteger        lastUnitMask;
+    std::vector<UnitInteger> changed;
+    std::vector<UnitInteger> active;
+
+public:
+    TileSet(const Size& size)
+        : tileNumber((size.cx + tileSize - 1) / tileSize, (size.cy + tileSize - 1) / tileSize)
+        , unitNumberX((tileNumber.cx + tileSize - 1) / tileSize)
+        , lastUnitMask(tileNumber.cx % tileSize == 0 ? ~UnitInteger(0) : (UnitInteger(1) << tileNumber.cx % tileSize) - 1)
+        , changed(unitNumberX * tileNumber.cy), active(unitNumberX * tileNumber.cy)
+    { SetAll(); }
+
+    Size GetTileNumber() const
+    { return tileNumber; }
+
+    const UnitInteger* GetActive(Integer tileY) const
+    { return &active[unitNumberX * tileY]; }
+
+    UnitInteger* GetChanged(Integer tileY)
+    { return &changed[unitNumberX * tileY]; }
+
+    /// <summary>Makes every tile active for the next two generations, for boards that were changed from outside.</summary>
+    /// <remarks>Until both boards have been computed, the other board holds no generation to compare with.</remarks>
+    void SetAll()
+    {
+        for (auto tileY = 0; tileY < tileNumber.cy; tileY++) {
+            const auto row = &active[unitNumberX * tileY];
+            std::fill(row, row + unitNumberX, ~UnitInteger(0));
+            row[unitNumberX - 1] &= lastUnitMask;
+        }
+        changed = active;
+    }
+
+    /// <summary>Activates the changed tiles and their neighbors, and clears the changes.</summary>
+    /// <param name="torus">Whether the tiles on an edge are neighbors of the tiles on the opposite edge.</param>
+    void Update(bool torus = false)
+    {
+        const auto lastTileX = UnsignedInteger(tileNumber.cx - 1);
+
+        for (auto tileY = 0; tileY < tileNumber.cy; tileY++) {
+            const auto row = &active[unitNumberX * tileY];
+            std::fill(row, row + unitNumberX, UnitInteger(0));
+
+            for (auto neighborY = tileY - 1; neighborY <= tileY + 1; neighborY++) {
+                if (!torus && (neighborY < 0 || tileNumber.cy <= neighborY))
+                    continue;
+
+                const auto source = &changed[unitNumberX * ((neighborY + tileNumber.cy) % tileNumber.cy)];
+                for (auto index = 0U; index < unitNumberX; index++) {
+                    const auto left  = index > 0U               ? source[index - 1] : UnitInteger(0);
+                    const auto right = index + 1U < unitNumberX ? source[index + 1] : UnitInteger(0);
+                    row[index] |= source[index] | (source[index] << 1) | (left  >> (tileSize - 1))
+                                                | (source[index] >> 1) | (right << (tileSize - 1));
+                }
+                if (torus) {
+                    row[0]                     |= (source[lastTileX / tileSize] >> (lastTileX % tileSize)) & 1U;
+                    row[lastTileX / tileSize]  |= (source[0] & 1U) << (lastTileX % tileSize);
+                }
+            }
+            row[unitNumberX - 1] &= lastUnitMask;
+        }
+        std::fill(changed.begin(), changed.end(), UnitInteger(0));
+    }
+
+    /// <returns>The first index in [begin, end) whose bit is value, or end.</returns>
+    static UnsignedInteger Find(const UnitInteger* bits, UnsignedInteger begin, UnsignedInteger end, bool value)
+    {
+        while (begin < end) {
+            const auto unit   = (value ? bits[begin / tileSize] : ~bits[begin / tileSize]) >> (begin % tileSize);
+            if (unit != 0)
+                return std::min(begin + UnsignedInteger(std::countr_zero(unit)), end);
+            begin += tileSize - begin % tileSize;
+        }
+        return end;
+    }
+};
+#endif // TILE
+
+class BitCellSet
+{
+    static constexpr UnsignedInteger bitNumber   = sizeof(UnitInteger) * 8;
+    static constexpr Integer         blockHeight = 64; // rows per block of Next with a depth
+
+    const Size      size;
+    UnsignedInteger unitNumberX;
+    UnsignedInteger unitStride;
+    UnitInteger     lastUnitMask;
+    UnitInteger*    buffer;
+    UnitInteger*    cells;
+    Topology        topology;
+    RuleKernel      kernel;
+
+#if defined(AREA)
+    Rect            area;
+#endif // AREA
+#if defined(CYCLE)
+    std::vector<UnitInteger> rowHashes; // the hash of each row, updated wherever a unit changes
+#endif // CYCLE
+#if defined(STATISTICS)
+    std::vector<KernelImplementation::RowCount> rowCounts; // the counts of each row Next wrote last
+#endif // STATISTICS
+
+public:
+    Size GetSize() const
+    { return size; }
+
+    Topology GetTopology() const
+    { return topology; }
+
+    void SetTopology(Topology topology)
+    {
+        this->topology = topology;
+        if (topology == Topology::Bounded)
+            ClearGhosts();
+    }
+
+    const Rule& GetRule() const
+    { return kernel.GetRule(); }
+
+    /// <remarks>Not while a generation is being computed.</remarks>
+    void SetRule(const Rule& rule)
+    { kernel = RuleKernel(rule); }
+
+#if defined(CYCLE)
+    /// <summary>A Zobrist-style hash of the cells: the XOR of a pseudo-random value for each alive unit of 64 cells and its position.</summary>
+    /// <remarks>Set and Next keep the hash of each row up to date where units change, so this only combines the rows.</remarks>
+    UnitInteger GetHash() const
+    {
+        UnitInteger hash = 0U;
+        for (const auto rowHash : rowHashes)
+            hash ^= rowHash;
+        return hash;
+    }
+#endif // CYCLE
+
+#if defined(STATISTICS)
+    /// <summary>Combines the counts Next wrote into the rows [top, bottom).</summary>
+    /// <remarks>The rows have to be the ones Next computed last, as the counts of the other rows are of older generations.</remarks>
+    Statistics GetStatistics(Integer top, Integer bottom) const
+    {
+        Statistics statistics;
+        for (auto y = top; y < bottom; y++)
+            statistics.Add(Statistics(rowCounts[size_t(y)], y));
+        return statistics;
+    }
+
+    /// <summary>Counts the alive cells of the rows [top, bottom) as they are, with no births or deaths.</summary>
+    Statistics Count(Integer top, Integer bottom) const
+    {
+        Statistics statistics;
+        for (auto y = top; y < bottom; y++) {
+            const auto row = cells + unitStride * y;
+            statistics.Add(Statistics(Kernel::CountRow(row, row, 0U, unitNumberX, lastUnitMask), y));
+        }
+        return statistics;
+    }
+#endif // STATISTICS
+
+    Rect GetArea() const
+#if defined(AREA)
+    { return area; }
+
+    static Rect GetDefaultArea(const Rect& rect)
+    { return Rect(Point(rect.leftTop.x + std::max(0, rect.size.cx / 2 - 1), rect.leftTop.y + std::max(0, rect.size.cy / 2 - 1)), Size(std::min(rect.size.cx, 3), std::min(rect.size.cy, 3))); }
+
+    void SetArea(const Rect& newArea)
+    { area = newArea; }
+
+#else // AREA
+    { return GetRect(); }
+#endif // AREA
+
+    UnitInteger* GetBits() const
+    { return cells; }
+
+    /// <summary>Bytes from the start of one row of GetBits() to the next.</summary>
+    UnsignedInteger GetBitsStride() const
+    { return unitStride * sizeof(UnitInteger); }
+
+    /// <remarks>
+    /// Each row is stored as 64-bit units (bit n of a unit is the n-th cell from the left) followed by a zero guard unit,
+    /// and a zero guard row lies above and below the board, so that Next can read every neighbor without bounds checks.
+    /// </remarks>
+    BitCellSet(const Size& size) : size(size), topology(Topology::Bounded)
+#if defined(AREA)
+        , area(GetDefaultArea(Rect(Point(), size)))
+#endif // AREA
+#if defined(STATISTICS)
+        , rowCounts(size_t(std::max(size.cy, 0)))
+#endif // STATISTICS
+    { Initialize(); }
 
     virtual ~BitCellSet()
-    { delete[] cells; }
+    { delete[] buffer; }
 
     bool Get(const Point& point) const
     {
@@ -489,7 +1278,15 @@ public:
             return false;
 
         const auto [index, bit] = bitIndex;
-        return (cells[index] & (1 << bit)) != 0;
+        return (cells[index] & (UnitInteger(1) << bit)) != 0;
+    }
+
+    /// <summary>Gets a cell without bounds checks.</summary>
+    /// <remarks>point may be one cell outside the board, where the guard units hold the ghost cells.</remarks>
+    bool GetOnly(const Point& point) const
+    {
+        const auto x = point.x + Integer(bitNumber);
+        return (GetRow(point.y)[x / Integer(bitNumber) - 1] >> (x % Integer(bitNumber)) & 1U) != 0U;
     }
 
     void Set(const Point& point, bool value)
@@ -501,7 +1298,7 @@ public:
 
         const auto [index, bit] = bitIndex;
         if (value) {
-            cells[index] |= 1 << bit;
+            SetUnit(point, cells[index] | UnitInteger(1) << bit);
             area = Union(area, GetRect(), point);
 #if defined(_DEBUG)
             const auto rightBottom     = GetRect().RightBottom();
@@ -510,7 +1307,7 @@ public:
             assert(point.y == GetRect().leftTop.y || point.y == rightBottom.y - 1 || (area.leftTop.y < point.y && point.y < areaRightBottom.y - 1));
 #endif // _DEBUG
         } else {
-            cells[index] &= ~(1 << bit);
+            SetUnit(point, cells[index] & ~(UnitInteger(1) << bit));
         }
 #else // AREA
         SetOnly(point, value);
@@ -524,15 +1321,90 @@ public:
             return;
 
         const auto [index, bit] = bitIndex;
-        value ? (cells[index] |= 1 << bit)
-              : (cells[index] &= ~(1 << bit));
+        SetUnit(point, value ? cells[index] |   UnitInteger(1) << bit
+                             : cells[index] & ~(UnitInteger(1) << bit));
+    }
+
+    /// <summary>Adds the alive cells of pattern with its left top cell at leftTop; the cells off the board are dropped.</summary>
+    /// <remarks>Each unit of the pattern is shifted into at most two units of the board, and the area grows once, to the bounds of the pattern.</remarks>
+    void Place(const Pattern& pattern, const Point& leftTop)
+    {
+        const auto patternSize = pattern.GetSize();
+        const auto left        = std::max(leftTop.x, 0);
+        const auto top         = std::max(leftTop.y, 0);
+        const auto right       = std::min(leftTop.x + patternSize.cx, size.cx);
+        const auto bottom      = std::min(leftTop.y + patternSize.cy, size.cy);
+        if (left >= right || top >= bottom)
+            return;
+
+        const auto patternUnitNumberX = Pattern::GetUnitNumberX(patternSize.cx);
+        for (auto y = top; y < bottom; y++) {
+            const auto source = pattern.GetRow(y - leftTop.y);
+            for (auto index = 0U; index < patternUnitNumberX; index++) {
+                auto unit = source[index];
+                auto x    = leftTop.x + Integer(index * bitNumber);
+                if (unit == 0U || x <= -Integer(bitNumber) || size.cx <= x)
+                    continue;
+                if (x < 0) {
+                    unit >>= -x;
+                    x      = 0;
+                }
+                const auto unitX = UnsignedInteger(x) / bitNumber;
+                const auto shift = UnsignedInteger(x) % bitNumber;
+                Add(Point(x, y), unit << shift);
+                if (shift != 0U && unitX + 1U < unitNumberX)
+                    Add(Point(Integer((unitX + 1U) * bitNumber), y), unit >> (bitNumber - shift));
+            }
+        }
+#if defined(AREA)
+        area = Union(Union(area, GetRect(), Point(left, top)), GetRect(), Point(right - 1, bottom - 1));
+#endif // AREA
     }
 
     void Clear()
     {
-        ::memset(cells, 0, GetUnitNumber() * (sizeof(UnitInteger) / sizeof(Byte)));
+        ::memset(buffer, 0, GetUnitNumber() * sizeof(UnitInteger));
 #if defined(AREA)
         area = GetDefaultArea(GetRect());
+#endif // AREA
+#if defined(CYCLE)
+        rowHashes.assign(size_t(size.cy), 0U);
+#endif // CYCLE
+    }
+
+    /// <summary>Copies the cells on the edges to the ghost cells around the board, for a torus.</summary>
+    /// <remarks>
+    /// Call once per generation before Next. The guard rows get the opposite rows; the padding bit after the last cell,
+    /// or bit 0 of the guard unit after a row, gets the first cell of the row; bit 63 of the guard unit before a row
+    /// gets its last cell. Under AREA, an area that touches an edge is widened to the whole span.
+    /// </remarks>
+    void UpdateGhosts()
+    {
+        if (topology == Topology::Bounded)
+            return;
+
+        const auto lastBit = UnsignedInteger(size.cx) % bitNumber;
+        for (auto y = 0; y < size.cy; y++) {
+            const auto row = GetRow(y);
+            row[unitNumberX - 1] &= lastUnitMask;
+            if (lastBit != 0U)
+                row[unitNumberX - 1] |= (row[0] & 1U) << lastBit;
+        }
+        ::memcpy(GetRow(-1     ), GetRow(size.cy - 1), unitNumberX * sizeof(UnitInteger));
+        ::memcpy(GetRow(size.cy), GetRow(0          ), unitNumberX * sizeof(UnitInteger));
+
+        // The guard unit after a row is also the one before the next row.
+        for (auto y = -1; y <= size.cy + 1; y++)
+            GetRow(y)[-1] = 0U;
+        const auto lastX = UnsignedInteger(size.cx - 1);
+        for (auto y = -1; y <= size.cy; y++) {
+            const auto row = GetRow(y);
+            row[-1]          |= (row[lastX / bitNumber] >> (lastX % bitNumber)) << (bitNumber - 1);
+            row[unitNumberX] |= row[0] & 1U;
+        }
+
+#if defined(AREA)
+        area = Wrap(area, GetRect());
 #endif // AREA
     }
 
@@ -545,6 +1417,153 @@ public:
 #if !defined(FAST)
     void ForEach(std::function<void(const Point&)> action, bool areaOnly)
     { Utility::ForEach(areaOnly ? GetArea() : GetRect(), action); }
+#else // FAST
+    /// <summary>Writes the rows [minimum.y, maximum.y) of the next generation into next, a vector of units at a time.</summary>
+    /// <remarks>Every unit that overlaps [minimum.x, maximum.x) is written.</remarks>
+#if defined(AREA)
+    void Next(BitCellSet& next, const Point& minimum, const Point& maximum, Rect& nextArea) const
+#else // AREA
+    void Next(BitCellSet& next, const Point& minimum, const Point& maximum) const
+#endif // AREA
+    {
+        assert(next.size == size);
+
+        const auto leftUnit  = UnsignedInteger(minimum.x) / bitNumber;
+        const auto rightUnit = (UnsignedInteger(maximum.x) + bitNumber - 1) / bitNumber;
+
+        for (auto y = minimum.y; y < maximum.y; y++) {
+            const auto center     = cells      + unitStride * y;
+            const auto nextCenter = next.cells + unitStride * y;
+
+            kernel.NextRow(center, unitStride, nextCenter, leftUnit, rightUnit);
+            if (rightUnit == unitNumberX)
+                nextCenter[unitNumberX - 1] &= lastUnitMask;
+
+#if defined(AREA)
+            nextArea = Union(nextArea, nextCenter, leftUnit, rightUnit, y);
+#endif // AREA
+#if defined(CYCLE)
+            next.rowHashes[y] = rowHashes[y] ^ GetHashDelta(center, nextCenter, leftUnit, rightUnit, y);
+#endif // CYCLE
+#if defined(STATISTICS)
+            next.rowCounts[size_t(y)] = Kernel::CountRow(center, nextCenter, leftUnit, rightUnit, rightUnit == unitNumberX ? lastUnitMask : ~UnitInteger(0));
+#endif // STATISTICS
+        }
+    }
+
+    /// <summary>Writes the rows [minimum.y, maximum.y) of the generation depth steps later into next, a block of rows at a time.</summary>
+    /// <remarks>
+    /// Temporal blocking: a block of rows, with depth rows above and below it, is advanced depth generations in two buffers
+    /// that stay in cache, the valid rows shrinking by one on each side per generation.
+    /// Every unit that overlaps [minimum.x, maximum.x) is computed, so the cells outside must stay dead for depth generations.
+    /// The board must be bounded.
+    /// </remarks>
+#if defined(AREA)
+    void Next(BitCellSet& next, const Point& minimum, const Point& maximum, UnsignedInteger depth, Rect& nextArea) const
+#else // AREA
+    void Next(BitCellSet& next, const Point& minimum, const Point& maximum, UnsignedInteger depth) const
+#endif // AREA
+    {
+        assert(next.size == size);
+        assert(topology == Topology::Bounded && depth > 0U);
+
+        const auto leftUnit  = UnsignedInteger(minimum.x) / bitNumber;
+        const auto rightUnit = (UnsignedInteger(maximum.x) + bitNumber - 1) / bitNumber;
+        const auto halo      = Integer(depth);
+
+        // Reused by each thread, so that no block allocates once the buffers have grown.
+        thread_local std::vector<UnitInteger> buffers[2];
+
+        for (auto top = minimum.y; top < maximum.y; top += blockHeight) {
+            const auto bottom     = std::min(top + blockHeight, maximum.y);
+            const auto unitNumber = size_t(unitStride) * (bottom - top + 2 * halo + 2) + 1; // the rows from top - depth to bottom + depth, and a guard row above and below
+            for (auto& buffer : buffers) {
+                if (buffer.size() < unitNumber)
+                    buffer.resize(unitNumber);
+            }
+            const auto blockRow = [&](UnsignedInteger index, Integer y) { return buffers[index].data() + unitStride + 1 + Integer(unitStride) * (y - top + halo); };
+
+            // The units on both sides of [leftUnit, rightUnit) and the rows off the board are read but never written, so they are kept dead.
+            for (auto index = 0U; index < 2U; index++) {
+                for (auto y = top - halo - 1; y <= bottom + halo; y++) {
+                    const auto row = blockRow(index, y);
+                    if (y < 0 || size.cy <= y) {
+                        std::fill(row - 1, row - 1 + unitStride, UnitInteger(0));
+                    } else {
+                        row[Integer(leftUnit) - 1] = 0U;
+                        row[rightUnit            ] = 0U;
+                    }
+                }
+            }
+
+            // The first generation reads the board and the last one writes next, so the block is never copied.
+            for (auto step = 1; step <= halo; step++) {
+                for (auto y = std::max(top - halo + step, 0); y < std::min(bottom + halo - step, size.cy); y++) {
+                    const auto center     = step == 1    ? GetRow(y)      : blockRow(UnsignedInteger(step - 2) % 2U, y);
+                    const auto nextCenter = step == halo ? next.GetRow(y) : blockRow(UnsignedInteger(step - 1) % 2U, y);
+                    kernel.NextRow(center, unitStride, nextCenter, leftUnit, rightUnit);
+                    if (rightUnit == unitNumberX)
+                        nextCenter[unitNumberX - 1] &= lastUnitMask;
+                    if (step == halo) {
+#if defined(AREA)
+                        nextArea = Union(nextArea, nextCenter, leftUnit, rightUnit, y);
+#endif // AREA
+#if defined(CYCLE)
+                        next.rowHashes[y] = rowHashes[y] ^ GetHashDelta(GetRow(y), nextCenter, leftUnit, rightUnit, y);
+#endif // CYCLE
+#if defined(STATISTICS)
+                        next.rowCounts[size_t(y)] = Kernel::CountRow(center, nextCenter, leftUnit, rightUnit, rightUnit == unitNumberX ? lastUnitMask : ~UnitInteger(0));
+#endif // STATISTICS
+                    }
+                }
+            }
+        }
+    }
+
+#if defined(TILE)
+    /// <summary>Writes the active tiles in the row of tiles tileY of the next generation into next, and marks the tiles that changed.</summary>
+    /// <remarks>
+    /// A tile is one unit wide. next holds the generation before this one, so a tile is marked as changed when it differs
+    /// from two generations before: a still life or a blinker is not, and next keeps its state when the tile is inactive.
+    /// </remarks>
+    void Next(BitCellSet& next, Integer tileY, const UnitInteger* active, UnitInteger* changed) const
+    {
+        assert(next.size == size);
+
+        const auto top    = tileY * TileSet::tileSize;
+        const auto bottom = std::min(top + TileSet::tileSize, size.cy);
+
+        // Reused by each thread, so that no row allocates once the buffer has grown.
+        thread_local std::vector<UnitInteger> previous;
+        if (previous.size() < unitNumberX)
+            previous.resize(unitNumberX);
+
+        for (auto begin = TileSet::Find(active, 0U, unitNumberX, true); begin < unitNumberX; begin = TileSet::Find(active, begin, unitNumberX, true)) {
+            const auto end = TileSet::Find(active, begin, unitNumberX, false);
+
+            for (auto y = top; y < bottom; y++) {
+                const auto center     = cells      + unitStride * y;
+                const auto nextCenter = next.cells + unitStride * y;
+
+                std::copy(nextCenter + begin, nextCenter + end, previous.begin() + begin);
+                kernel.NextRow(center, unitStride, nextCenter, begin, end);
+                if (end == unitNumberX)
+                    nextCenter[unitNumberX - 1] &= lastUnitMask;
+
+                for (auto index = begin; index < end; index++) {
+                    const auto mask = index + 1U == unitNumberX ? lastUnitMask : ~UnitInteger(0);
+                    if (((nextCenter[index] ^ previous[index]) & mask) != 0U) {
+                        changed[index / TileSet::tileSize] |= UnitInteger(1) << (index % TileSet::tileSize);
+#if defined(CYCLE)
+                        next.rowHashes[y] ^= GetHashDelta(GetHashKey(y, index), previous[index] & mask, nextCenter[index]);
+#endif // CYCLE
+                    }
+                }
+            }
+            begin = end;
+        }
+    }
+#endif // TILE
 #endif // FAST
 
 #if defined(AREA)
@@ -574,6 +1593,41 @@ public:
 
         return Rect(Point(left, top), Point(right, bottom));
     }
+
+    /// <summary>Adds the first and last alive cells in the units [leftUnit, rightUnit) of row y to area.</summary>
+    Rect Union(const Rect& area, const UnitInteger* row, UnsignedInteger leftUnit, UnsignedInteger rightUnit, Integer y) const
+    {
+        auto leftIndex  = leftUnit;
+        auto rightIndex = rightUnit;
+        while (leftIndex < rightIndex && row[leftIndex] == 0)
+            leftIndex++;
+        while (leftIndex < rightIndex && row[rightIndex - 1] == 0)
+            rightIndex--;
+        if (leftIndex == rightIndex)
+            return area;
+
+        const auto left  = Integer(leftIndex  * bitNumber + std::countr_zero(row[leftIndex     ]));
+        const auto right = Integer(rightIndex * bitNumber - 1 - std::countl_zero(row[rightIndex - 1]));
+        return Union(Union(area, GetRect(), Point(left, y)), GetRect(), Point(right, y));
+    }
+
+    /// <summary>Widens area to the whole width or height of rect where it touches an edge, as the cells there affect the opposite edge on a torus.</summary>
+    static Rect Wrap(const Rect& area, const Rect& rect)
+    {
+        auto       leftTop         = area.leftTop;
+        auto       rightBottom     = area.RightBottom();
+        const auto rectRightBottom = rect.RightBottom();
+
+        if (leftTop.x == rect.leftTop.x || rightBottom.x == rectRightBottom.x) {
+            leftTop    .x = rect.leftTop    .x;
+            rightBottom.x = rectRightBottom .x;
+        }
+        if (leftTop.y == rect.leftTop.y || rightBottom.y == rectRightBottom.y) {
+            leftTop    .y = rect.leftTop    .y;
+            rightBottom.y = rectRightBottom .y;
+        }
+        return Rect(leftTop, rightBottom);
+    }
 #endif // AREA
 
 #if !defined(AREA) || !defined(MT)
@@ -592,33 +1646,105 @@ private:
 #endif // _DEBUG
     }
 
+    /// <remarks>y may be -1 or size.cy for the guard rows.</remarks>
+    UnitInteger* GetRow(Integer y) const
+    { return cells + Integer(unitStride) * y; }
+
+    /// <summary>Makes the cells of bits alive in the unit that holds point; the bits after the last cell are dropped.</summary>
+    void Add(const Point& point, UnitInteger bits)
+    {
+        const auto unitX = UnsignedInteger(point.x) / bitNumber;
+        const auto index = unitStride * UnsignedInteger(point.y) + unitX;
+        SetUnit(point, cells[index] | (unitX + 1U == unitNumberX ? bits & lastUnitMask : bits));
+    }
+
+    /// <summary>Writes unit to the unit that holds point.</summary>
+    void SetUnit(const Point& point, UnitInteger unit)
+    {
+        const auto unitX = UnsignedInteger(point.x) / bitNumber;
+        const auto index = unitStride * UnsignedInteger(point.y) + unitX;
+#if defined(CYCLE)
+        const auto mask  = unitX + 1U == unitNumberX ? lastUnitMask : ~UnitInteger(0);
+        if (((cells[index] ^ unit) & mask) != 0U)
+            rowHashes[point.y] ^= GetHashDelta(GetHashKey(point.y, unitX), cells[index] & mask, unit & mask);
+#endif // CYCLE
+        cells[index] = unit;
+    }
+
+#if defined(CYCLE)
+    static constexpr UnitInteger hashKeyStep = 0x9E3779B97F4A7C15ULL; // 2^64 divided by the golden ratio
+
+    /// <summary>The key of the unit index of row y; the keys of a row are hashKeyStep apart.</summary>
+    UnitInteger GetHashKey(Integer y, UnsignedInteger index) const
+    { return (UnitInteger(y) * unitNumberX + index + 1U) * hashKeyStep; }
+
+    /// <summary>The change of the hash when the unit with key changes from unit to nextUnit (both without padding bits).</summary>
+    /// <remarks>The value of a unit is Mix(unit + key) ^ Mix(key), which is 0 for a dead unit; Mix(key) cancels out here.</remarks>
+    static UnitInteger GetHashDelta(UnitInteger key, UnitInteger unit, UnitInteger nextUnit)
+    { return Mix(unit + key) ^ Mix(nextUnit + key); }
+
+    /// <summary>The change of the hash of row y from row to nextRow, in the units [leftUnit, rightUnit).</summary>
+    UnitInteger GetHashDelta(const UnitInteger* row, const UnitInteger* nextRow, UnsignedInteger leftUnit, UnsignedInteger rightUnit, Integer y) const
+    {
+        UnitInteger delta = 0U;
+        if (leftUnit >= rightUnit || ::memcmp(row + leftUnit, nextRow + leftUnit, (rightUnit - leftUnit) * sizeof(UnitInteger)) == 0)
+            return delta;
+
+        auto key = GetHashKey(y, leftUnit);
+        // No branch: an unchanged unit adds 0, and most units change while the board is chaotic.
+        for (auto index = leftUnit; index < rightUnit; index++, key += hashKeyStep) {
+            const auto mask = index + 1U == unitNumberX ? lastUnitMask : ~UnitInteger(0);
+            delta ^= GetHashDelta(key, row[index] & mask, nextRow[index] & mask);
+        }
+        return delta;
+    }
+
+    /// <summary>A bijective xorshift-multiply mix with one multiplication.</summary>
+    static constexpr UnitInteger Mix(UnitInteger value)
+    {
+        value = (value ^ (value >> 32)) * 0xD6E8FEB86659FD93ULL;
+        return value ^ (value >> 32);
+    }
+#endif // CYCLE
+
+    void ClearGhosts()
+    {
+        ::memset(GetRow(-1     ) - 1, 0, unitStride * sizeof(UnitInteger));
+        ::memset(GetRow(size.cy) - 1, 0, (unitStride + 1) * sizeof(UnitInteger));
+        for (auto y = 0; y < size.cy; y++) {
+            const auto row = GetRow(y);
+            row[-1]              = 0U;
+            row[unitNumberX - 1] &= lastUnitMask;
+        }
+    }
+
     void Initialize()
     {
         InitializeUnitNumberX();
-        const auto unitNumber = GetUnitNumber();
-        cells                 = new UnitInteger[unitNumber];
+        buffer = new UnitInteger[GetUnitNumber()];
+        cells  = buffer + unitStride + 1;
         Clear();
     }
 
     void InitializeUnitNumberX()
     {
-        unitNumberX = size.cx / sizeof(UnitInteger);
-        if (size.cx % sizeof(UnitInteger) != 0) {
-            assert(false);
-            unitNumberX++;
-        }
+        unitNumberX = (size.cx + bitNumber - 1) / bitNumber;
+        unitStride  = unitNumberX + 1;
+
+        const auto lastBitNumber = size.cx % bitNumber;
+        lastUnitMask             = lastBitNumber == 0 ? ~UnitInteger(0) : (UnitInteger(1) << lastBitNumber) - 1;
     }
 
+    /// <remarks>The rows, the guard rows and one more guard unit after the last one.</remarks>
     UnsignedInteger GetUnitNumber() const
-    { return unitNumberX * size.cy; }
+    { return unitStride * (size.cy + 2) + 1; }
 
     bool ToIndex(const Point& point, std::tuple<UnsignedInteger, Byte>& bitIndex) const
     {
         if (!GetRect().IsIn(point))
             return false;
 
-        constexpr auto bitNumber = sizeof(UnitInteger) * 8;
-        const auto index         = UnsignedInteger(unitNumberX * point.y + point.x / bitNumber);
+        const auto index         = UnsignedInteger(unitStride * point.y + point.x / bitNumber);
         const auto bit           = Byte(point.x % bitNumber);
         bitIndex                 = { index, bit };
         return true;
@@ -628,58 +1754,97 @@ private:
 #if !defined(USEBITS)
 class Board final
 {
+    static constexpr UnsignedInteger alignment = 64U;
+    static constexpr UnsignedInteger bitNumber = sizeof(UnitInteger) * 8;
+
     const Size      size;
-    bool**          cells;
-    BitCellSet*     bitCellSet;
+    UnsignedInteger stride;
+    bool*           buffer;
+    bool*           cells;
+    BitCellSet      frame;
+    Topology        topology;
+    Rule            rule;
 
 #if defined(AREA)
     Rect            area;
+    Rect            frameArea;
 #endif // AREA
 
 public:
     Size GetSize() const
     { return size; }
 
+    Topology GetTopology() const
+    { return topology; }
+
+    void SetTopology(Topology topology)
+    {
+        this->topology = topology;
+        if (topology == Topology::Bounded)
+            ClearGhosts();
+    }
+
+    const Rule& GetRule() const
+    { return rule; }
+
+    void SetRule(const Rule& rule)
+    { this->rule = rule; }
+
     Rect GetArea() const
 #if defined(AREA)
     { return area; }
-#if defined(MT)
+
     void SetArea(const Rect& newArea)
     { area = newArea; }
-#endif // MT
 #else // AREA
     { return GetRect(); }
 #endif // AREA
 
+    /// <summary>Packs the cells into a persistent frame in the layout of BitCellSet::GetBits(), and returns it.</summary>
+    /// <remarks>Only the union of the area and the area packed last time is packed again; the frame is never reallocated.</remarks>
     UnitInteger* GetBits()
     {
-        delete bitCellSet;
-        bitCellSet = new BitCellSet(size);
-
-#if defined(FAST)
-        for (auto point = Point{ 0, 0 }; point.y < size.cy; point.y++) {
-            for (point.x = 0; point.x < size.cx; point.x++)
-                bitCellSet->Set(point, Get(point));
+        const auto rect = GetFrameRect();
+        if (rect.size.cx > 0 && rect.size.cy > 0) {
+            const auto unitStride    = frame.GetBitsStride() / UnsignedInteger(sizeof(UnitInteger));
+            const auto unitNumberX   = (UnsignedInteger(size.cx) + bitNumber - 1U) / bitNumber;
+            const auto lastBitNumber = UnsignedInteger(size.cx) % bitNumber;
+            const auto lastUnitMask  = lastBitNumber == 0 ? ~UnitInteger(0) : (UnitInteger(1) << lastBitNumber) - 1;
+            const auto firstUnit     = UnsignedInteger(rect.leftTop.x) / bitNumber;
+            const auto lastUnit      = UnsignedInteger(rect.leftTop.x + rect.size.cx - 1) / bitNumber;
+
+            for (auto y = rect.leftTop.y; y < rect.leftTop.y + rect.size.cy; y++) {
+                const auto row  = GetRow(y);
+                const auto bits = frame.GetBits() + unitStride * UnsignedInteger(y);
+                for (auto index = firstUnit; index <= lastUnit; index++)
+                    bits[index] = Pack(row + index * bitNumber);
+                if (lastUnit + 1U == unitNumberX)
+                    bits[lastUnit] &= lastUnitMask; // The ghost cell and the padding after the row are not cells.
+            }
         }
-#else // FAST
-        Utility::ForEach(Rect{ Point {0, 0}, size }, [&](const Point& point) { bitCellSet->Set(point, Get(point)); });
-#endif // FAST
-
-        return bitCellSet->GetBits();
+#if defined(AREA)
+        frameArea = area;
+#endif // AREA
+        return frame.GetBits();
     }
 
-    /// <remarks>size.cx must be a multiple of 8.</remarks>
-    Board(const Size& size) : size(size), bitCellSet(nullptr)
+    /// <summary>Bytes from the start of one row of GetBits() to the next.</summary>
+    UnsignedInteger GetBitsStride() const
+    { return frame.GetBitsStride(); }
+
+    /// <remarks>
+    /// The cells are one 64-byte aligned block of rows with a ghost border of one cell, so that the neighbors of a cell
+    /// are at fixed offsets (-1, +1, -stride and +stride) and need no bounds checks.
+    /// size.cx may be any width: Pack reads the 64 cells of the last unit of a row past its end, which stays in the block, and GetBits masks them off.
+    /// </remarks>
+    Board(const Size& size) : size(size), frame(size), topology(Topology::Bounded)
 #if defined(AREA)
-        , area(BitCellSet::GetDefaultArea(Rect(Point(), size)))
+        , area(BitCellSet::GetDefaultArea(Rect(Point(), size))), frameArea(Rect(Point(), size))
 #endif // AREA
     { Initialize(); }
 
     ~Board()
-    {
-        delete[] bitCellSet;
-        delete[] cells     ;
-    }
+    { ::operator delete[](buffer, std::align_val_t(alignment)); }
 
     bool Set(const Pattern& pattern)
     {
@@ -691,20 +1856,39 @@ public:
         Clear();
 
         const auto startPoint = Point{ (bitCellSetSize.cx - patternSize.cx) / 2, (bitCellSetSize.cy - patternSize.cy) / 2 };
-        size_t     patternIndex = 0U;
 
 #if defined(FAST)
-        for (Point point = startPoint; point.y < startPoint.y + patternSize.cy; point.y++) {
-            for (point.x = startPoint.x; point.x < startPoint.x + patternSize.cx; point.x++)
-                Set(point, pattern[patternIndex++]);
-        }
+        Place(pattern, startPoint);
 #else // FAST
+        size_t patternIndex = 0U;
         Utility::ForEach(Rect(startPoint, patternSize), [&](const Point& point) { Set(point, pattern[patternIndex++]); });
 #endif // FAST
 
         return true;
     }
 
+    /// <summary>Adds the alive cells of pattern with its left top cell at leftTop; the cells off the board are dropped.</summary>
+    /// <remarks>Only the alive cells of the pattern are visited, and the area grows once, to the bounds of the pattern.</remarks>
+    void Place(const Pattern& pattern, const Point& leftTop)
+    {
+        const auto patternSize = pattern.GetSize();
+        const auto left        = std::max(leftTop.x, 0);
+        const auto top         = std::max(leftTop.y, 0);
+        const auto right       = std::min(leftTop.x + patternSize.cx, size.cx);
+        const auto bottom      = std::min(leftTop.y + patternSize.cy, size.cy);
+        if (left >= right || top >= bottom)
+            return;
+
+        pattern.ForEachAlive([&](const Point& point) {
+            const auto boardPoint = leftTop + Size(point.x, point.y);
+            if (GetRect().IsIn(boardPoint))
+                SetOnly(boardPoint, true);
+        });
+#if defined(AREA)
+        area = BitCellSet::Union(BitCellSet::Union(area, GetRect(), Point(left, top)), GetRect(), Point(right - 1, bottom - 1));
+#endif // AREA
+    }
+
 #if !defined(FAST)
     void ForEach(std::function<void(const Point&)> action
 #if defined(AREA)
@@ -720,31 +1904,33 @@ public:
     }
 #endif // FAST
 
+    /// <remarks>Call UpdateGhosts first on a torus.</remarks>
     UnsignedInteger GetAliveNeighborCount(const Point& point) const
     {
 #if defined(FAST)
-        UnsignedInteger count = 0;
-        for (Point neighborPoint = { point.x - 1, point.y - 1 }; neighborPoint.y <= point.y + 1; neighborPoint.y++) {
-            for (neighborPoint.x = point.x - 1; neighborPoint.x <= point.x + 1; neighborPoint.x++) {
-                if (neighborPoint == point)
-                    continue;
-                if (Get(neighborPoint))
-                    count++;
-            }
-        }
-        return count;
+        const auto center = GetRow(point.y) + point.x;
+        const auto up     = center - stride;
+        const auto down   = center + stride;
+        return up  [-1] + up  [0] + up  [1] +
+               center[-1]         + center[1] +
+               down[-1] + down[0] + down[1];
 #else // FAST
         return Utility::Count(
             Rect(point + Size(-1, -1), Size(3, 3)),
             [&](const Point& neighborPoint) {
-                return neighborPoint != point && Get(neighborPoint);
+                return neighborPoint != point && GetOnly(neighborPoint);
             }
         );
 #endif // FAST
     }
 
     bool Get(const Point& point) const
-    { return GetRect().IsIn(point) ? cells[point.y][point.x] : false; }
+    { return GetRect().IsIn(point) ? GetRow(point.y)[point.x] : false; }
+
+    /// <summary>Gets a cell without bounds checks.</summary>
+    /// <remarks>point may be on the ghost border.</remarks>
+    bool GetOnly(const Point& point) const
+    { return GetRow(point.y)[point.x]; }
 
     void Set(const Point& point, bool value)
     {
@@ -756,94 +1942,212 @@ public:
     }
 
     void SetOnly(const Point& point, bool value)
-    { cells[point.y][point.x] = value; }
-
-private:
-    void Initialize()
-    {
-        cells = new bool*[size.cy];
-        for (auto y = 0; y < size.cy; y++)
-            cells[y] = new bool[size.cx];
-
-        Clear();
-    }
+    { GetRow(point.y)[point.x] = value; }
 
     void Clear()
     {
-        for (auto y = 0; y < size.cy; y++)
-            ::memset(cells[y], 0, sizeof(bool) * size.cx);
-
+        ::memset(buffer, 0, GetByteNumber());
 #if defined(AREA)
-        area = Rect(Point(std::min(0, size.cx / 2 - 1), std::min(0, size.cy / 2 - 1)), Size(std::min(size.cx, 3), std::min(size.cy, 3)));
+        area      = BitCellSet::GetDefaultArea(GetRect());
+        frameArea = GetRect(); // The frame may still hold cells anywhere.
 #endif // AREA
     }
 
+#if defined(FAST)
+    /// <summary>Writes the cells in [minimum, maximum) of the next generation into next.</summary>
+    /// <remarks>Walks the rows above, on and below each row with pointers, under the rule of the board.</remarks>
 #if defined(AREA)
-public:
+    void Next(Board& next, const Point& minimum, const Point& maximum, Rect& nextArea) const
+#else // AREA
+    void Next(Board& next, const Point& minimum, const Point& maximum) const
 #endif // AREA
-    Rect GetRect() const
-    { return Rect(Point(), size); }
-};
-#else // USEBITS
-class Board final : public BitCellSet
-{
-public:
-    Board(const Size& size) : BitCellSet(size)
-    {}
-
-    bool Set(const Pattern& pattern)
     {
-        const auto patternSize    = pattern.GetSize();
-        const auto bitCellSetSize = GetSize();
-        if (patternSize.cx > bitCellSetSize.cx || patternSize.cy > bitCellSetSize.cy)
-            return false;
-
-        Clear();
+        assert(next.size == size);
 
-        const auto startPoint   = Point { (bitCellSetSize.cx - patternSize.cx) / 2, (bitCellSetSize.cy - patternSize.cy) / 2 };
-        size_t     patternIndex = 0U;
+        for (auto y = minimum.y; y < maximum.y; y++) {
+            const auto center     = GetRow(y);
+            const auto nextCenter = next.GetRow(y);
+            if (rule == Rule::Conway())
+                NextRow<true >(center - stride, center, center + stride, nextCenter, minimum.x, maximum.x, rule);
+            else
+                NextRow<false>(center - stride, center, center + stride, nextCenter, minimum.x, maximum.x, rule);
 
-#if defined(FAST)
-        for (Point point = startPoint; point.y < startPoint.y + patternSize.cy; point.y++) {
-            for (point.x = startPoint.x; point.x < startPoint.x + patternSize.cx; point.x++)
-                Set(point, pattern[patternIndex++]);
+#if defined(AREA)
+            const auto first = std::find(nextCenter + minimum.x, nextCenter + maximum.x, true);
+            if (first != nextCenter + maximum.x) {
+                const auto last = std::find(std::make_reverse_iterator(nextCenter + maximum.x), std::make_reverse_iterator(first), true);
+                nextArea = BitCellSet::Union(nextArea, GetRect(), Point(Integer(first        - nextCenter), y));
+                nextArea = BitCellSet::Union(nextArea, GetRect(), Point(Integer(last.base() - nextCenter) - 1, y));
+            }
+#endif // AREA
         }
-#else // FAST
-        Utility::ForEach(Rect{ startPoint, patternSize }, [&](const Point& point) { Set(point, pattern[patternIndex++]); });
-#endif // FAST
-
-        return true;
     }
+#endif // FAST
 
-#if !defined(FAST)
-    void ForEach(std::function<void(const Point&)> action, bool areaOnly = false)
+    /// <summary>Copies the cells on the edges to the ghost border, for a torus.</summary>
+    /// <remarks>Call once per generation before computing the next one. Under AREA, an area that touches an edge is widened to the whole span.</remarks>
+    void UpdateGhosts()
     {
-#if defined(AREA)
-        Utility::ForEach(areaOnly ? GetArea() : GetRect(), action);
-#else // AREA
+        if (topology == Topology::Bounded)
+            return;
+
+        for (auto y = 0; y < size.cy; y++) {
+            const auto row = GetRow(y);
+            row[-1     ] = row[size.cx - 1];
+            row[size.cx] = row[0          ];
+        }
+        ::memcpy(GetRow(-1     ) - 1, GetRow(size.cy - 1) - 1, stride);
+        ::memcpy(GetRow(size.cy) - 1, GetRow(0          ) - 1, stride);
+
+#if defined(AREA)
+        area = BitCellSet::Wrap(area, GetRect());
+#endif // AREA
+    }
+
+private:
+#if defined(FAST)
+    /// <remarks>
+    /// next is another board, so the rows never overlap. A cell is alive next under B3/S23 if (neighbors | alive) == 3;
+    /// under any other rule, if the bit for its neighbor count is set in the birth or the survival mask.
+    /// </remarks>
+    template <bool conway>
+    static void NextRow(const bool* __restrict up, const bool* __restrict center, const bool* __restrict down, bool* __restrict next, Integer minimum, Integer maximum, const Rule& rule)
+    {
+        const auto birth    = rule.GetBirth   ();
+        const auto survival = rule.GetSurvival();
+        for (auto x = minimum; x < maximum; x++) {
+            const auto count = Byte(up    [x - 1] + up  [x] + up    [x + 1] +
+                                    center[x - 1]           + center[x + 1] +
+                                    down  [x - 1] + down[x] + down  [x + 1]);
+            if constexpr (conway)
+                next[x] = (count | Byte(center[x])) == 3;
+            else
+                next[x] = (((center[x] ? survival : birth) >> count) & 1U) != 0U;
+        }
+    }
+#endif // FAST
+
+    /// <remarks>
+    /// Each row starts on a 64-byte boundary with the ghost cell at -1, and is padded to a multiple of 64 bytes.
+    /// Rows -1 and size.cy are the ghost rows.
+    /// </remarks>
+    void Initialize()
+    {
+        stride = (UnsignedInteger(size.cx) + 2U + alignment - 1U) / alignment * alignment;
+        buffer = static_cast<bool*>(::operator new[](GetByteNumber(), std::align_val_t(alignment)));
+        cells  = buffer + stride + 1;
+        Clear();
+    }
+
+    size_t GetByteNumber() const
+    { return size_t(stride) * (size.cy + 2); }
+
+    /// <remarks>
+    /// The cells outside the area are dead, and so are the bits of the frame outside the area packed last time,
+    /// so packing the bounding rectangle of both brings the whole frame up to date.
+    /// </remarks>
+    Rect GetFrameRect() const
+    {
+#if defined(AREA)
+        const auto areaRightBottom      = area     .RightBottom();
+        const auto frameAreaRightBottom = frameArea.RightBottom();
+        return Rect(Point(std::min(area.leftTop.x, frameArea.leftTop.x), std::min(area.leftTop.y, frameArea.leftTop.y)),
+                    Point(std::max(areaRightBottom.x, frameAreaRightBottom.x), std::max(areaRightBottom.y, frameAreaRightBottom.y)));
+#else // AREA
+        return GetRect();
+#endif // AREA
+    }
+
+    /// <summary>Packs 64 cells into a unit, cell n to bit n.</summary>
+    /// <remarks>
+    /// Each multiplication gathers the lowest bits of 8 bytes into the top byte without carries
+    /// (byte n times 2^(56 - 7n) lands on bit 56 + n), so there are no branches and no per-cell shifts.
+    /// </remarks>
+    static UnitInteger Pack(const bool* cells)
+    {
+        UnitInteger unit = 0;
+        for (auto index = 0U; index < bitNumber / 8U; index++) {
+            std::uint64_t bytes;
+            ::memcpy(&bytes, cells + index * 8U, sizeof(bytes));
+            unit |= ((bytes * 0x0102040810204080ULL) >> 56) << (index * 8U);
+        }
+        return unit;
+    }
+
+    /// <remarks>y may be -1 or size.cy for the ghost rows.</remarks>
+    bool* GetRow(Integer y) const
+    { return cells + Integer(stride) * y; }
+
+    void ClearGhosts()
+    {
+        for (auto y = 0; y < size.cy; y++) {
+            const auto row = GetRow(y);
+            row[-1] = row[size.cx] = false;
+        }
+        ::memset(GetRow(-1     ) - 1, 0, stride);
+        ::memset(GetRow(size.cy) - 1, 0, stride);
+    }
+
+#if defined(AREA)
+public:
+#endif // AREA
+    Rect GetRect() const
+    { return Rect(Point(), size); }
+};
+#else // USEBITS
+class Board final : public BitCellSet
+{
+public:
+    Board(const Size& size) : BitCellSet(size)
+    {}
+
+    bool Set(const Pattern& pattern)
+    {
+        const auto patternSize    = pattern.GetSize();
+        const auto bitCellSetSize = GetSize();
+        if (patternSize.cx > bitCellSetSize.cx || patternSize.cy > bitCellSetSize.cy)
+            return false;
+
+        Clear();
+
+        const auto startPoint   = Point { (bitCellSetSize.cx - patternSize.cx) / 2, (bitCellSetSize.cy - patternSize.cy) / 2 };
+
+#if defined(FAST)
+        Place(pattern, startPoint);
+#else // FAST
+        size_t patternIndex = 0U;
+        Utility::ForEach(Rect{ startPoint, patternSize }, [&](const Point& point) { Set(point, pattern[patternIndex++]); });
+#endif // FAST
+
+        return true;
+    }
+
+#if !defined(FAST)
+    void ForEach(std::function<void(const Point&)> action, [[maybe_unused]] bool areaOnly = false)
+    {
+#if defined(AREA)
+        Utility::ForEach(areaOnly ? GetArea() : GetRect(), action);
+#else // AREA
         Utility::ForEach(GetRect(), action);
 #endif // AREA
     }
-#endif !FAST
+#endif // FAST
 
+    /// <remarks>Call UpdateGhosts first on a torus.</remarks>
     UnsignedInteger GetAliveNeighborCount(const Point& point) const
     {
 #if defined(FAST)
         UnsignedInteger count = 0;
         for (Point neighborPoint = { point.x - 1, point.y - 1 }; neighborPoint.y <= point.y + 1; neighborPoint.y++) {
-            for (neighborPoint.x = point.x - 1; neighborPoint.x <= point.x + 1; neighborPoint.x++) {
-                if (neighborPoint == point)
-                    continue;
-                if (Get(neighborPoint))
-                    count++;
-            }
+            for (neighborPoint.x = point.x - 1; neighborPoint.x <= point.x + 1; neighborPoint.x++)
+                count += GetOnly(neighborPoint);
         }
-        return count;
+        return count - GetOnly(point);
 #else // FAST
         return Utility::Count(
             Rect(point + Size(-1, -1), Size(3, 3)),
             [&](const Point& neighborPoint) {
-                return neighborPoint != point && Get(neighborPoint);
+                return neighborPoint != point && GetOnly(neighborPoint);
             }
         );
 #endif // FAST
@@ -857,6 +2161,177 @@ public:
 };
 #endif // USEBITS
 
+#if defined(CYCLE)
+/// <summary>The hashes of the recent generations of a board, to find the period once the board repeats.</summary>
+/// <remarks>
+/// Periods up to historyLength - 1 are found. A period is only as certain as the 64-bit hashes, which collide
+/// with a probability of about historyLength / 2^64 per generation.
+/// </remarks>
+class HashHistory final
+{
+public:
+    static constexpr UnsignedInteger historyLength = 256U;
+
+private:
+    struct Entry
+    {
+        UnitInteger        hash;
+        unsigned long long generation;
+    };
+
+    std::vector<Entry> entries;
+    UnsignedInteger    last  ;
+    unsigned long long period;
+
+public:
+    HashHistory() : entries(), last(0U), period(0ULL)
+    { entries.reserve(historyLength); }
+
+    bool IsEmpty() const
+    { return entries.empty(); }
+
+    UnitInteger GetLastHash() const
+    { return entries[last].hash; }
+
+    /// <returns>The number of generations after which the board repeats, or 0 if it has not repeated yet.</returns>
+    unsigned long long GetPeriod() const
+    { return period; }
+
+    void Clear()
+    {
+        entries.clear();
+        last   = 0U;
+        period = 0ULL;
+    }
+
+    void Add(UnitInteger hash, unsigned long long generation)
+    {
+        if (period == 0ULL) {
+            const auto entry = std::find_if(entries.begin(), entries.end(), [hash](const Entry& entry) { return entry.hash == hash; });
+            if (entry != entries.end())
+                period = generation - entry->generation;
+        }
+        if (entries.size() < historyLength) {
+            last = UnsignedInteger(entries.size());
+            entries.push_back({ hash, generation });
+        } else {
+            last = (last + 1U) % historyLength;
+            entries[last] = { hash, generation };
+        }
+    }
+};
+#endif // CYCLE
+
+/// <summary>A snapshot of a Game: the tiles of 64x64 cells that have alive cells, and the state of the game around them.</summary>
+/// <remarks>
+/// Game::GetCheckpoint copies only the tiles in the area, so that Write can run on another thread while the game goes on.
+/// A file is the header and the tiles, in the byte order of the machine; Read maps it and copies the tiles only.
+/// </remarks>
+struct Checkpoint final
+{
+    static constexpr Integer       tileSize = Integer(sizeof(UnitInteger) * 8);
+    static constexpr char          magic[8] = { 'S', 'h', 'o', 's', 'L', 'i', 'f', 'e' };
+    static constexpr std::uint32_t version  = 1U;
+
+    struct Tile final
+    {
+        std::uint32_t x; // in tiles
+        std::uint32_t y;
+        UnitInteger   rows[tileSize]; // bit n of a row is the n-th cell from the left
+    };
+
+    Size               size;
+    Topology           topology;
+    unsigned long long generation;
+    Rect               area;
+    Rule               rule;
+    std::string        randomState;
+    std::vector<Tile>  tiles;
+
+    Checkpoint() : topology(Topology::Bounded), generation(0ULL), area(Point(), Size())
+    {}
+
+    bool Write(const tstring& filePath) const
+    {
+#if defined(TRACE)
+        const Tracer::Span span("WriteCheckpoint");
+#endif // TRACE
+        std::ofstream stream(filePath, std::ios::binary | std::ios::trunc);
+        const auto write = [&](const auto& value) { stream.write(reinterpret_cast<const char*>(&value), sizeof(value)); };
+
+        write(magic);
+        write(version);
+        write(size.cx);
+        write(size.cy);
+        write(std::uint32_t(topology));
+        write(generation);
+        write(area.leftTop.x);
+        write(area.leftTop.y);
+        write(area.size.cx);
+        write(area.size.cy);
+        write(rule.GetBirth());
+        write(rule.GetSurvival());
+        write(std::uint64_t(randomState.size()));
+        stream.write(randomState.data(), std::streamsize(randomState.size()));
+        write(std::uint64_t(tiles.size()));
+        stream.write(reinterpret_cast<const char*>(tiles.data()), std::streamsize(tiles.size() * sizeof(Tile)));
+        return bool(stream);
+    }
+
+    /// <returns>false if the file is not a checkpoint of this version, is cut short, has an area or a tile off the board,
+    /// or has a topology, a rule or a state of Random that is not supported.</returns>
+    bool Read(const tstring& filePath)
+    {
+        const MappedFile file(filePath);
+        auto             data = file.GetText();
+        const auto       read = [&](void* value, size_t byteNumber) {
+            if (data.size() < byteNumber)
+                return false;
+            ::memcpy(value, data.data(), byteNumber);
+            data.remove_prefix(byteNumber);
+            return true;
+        };
+
+        char            fileMagic[sizeof(magic)];
+        std::uint32_t   fileVersion, fileTopology;
+        std::uint16_t   birth, survival;
+        std::uint64_t   randomStateSize, tileNumber;
+        if (!read(fileMagic, sizeof(fileMagic)) || ::memcmp(fileMagic, magic, sizeof(magic)) != 0 ||
+            !read(&fileVersion, sizeof(fileVersion)) || fileVersion != version ||
+            !read(&size.cx, sizeof(size.cx)) || !read(&size.cy, sizeof(size.cy)) || !read(&fileTopology, sizeof(fileTopology)) ||
+            !read(&generation, sizeof(generation)) ||
+            !read(&area.leftTop.x, sizeof(area.leftTop.x)) || !read(&area.leftTop.y, sizeof(area.leftTop.y)) ||
+            !read(&area.size.cx, sizeof(area.size.cx)) || !read(&area.size.cy, sizeof(area.size.cy)) ||
+            !read(&birth, sizeof(birth)) || !read(&survival, sizeof(survival)) ||
+            !read(&randomStateSize, sizeof(randomStateSize)) || data.size() < randomStateSize ||
+            fileTopology > std::uint32_t(Topology::Torus) || !Rule::IsSupported(birth, survival))
+            return false;
+
+        const auto areaRightBottom = area.RightBottom();
+        if (area.leftTop.x < 0 || area.leftTop.y < 0 || areaRightBottom.x > size.cx || areaRightBottom.y > size.cy || area.size.cx < 0 || area.size.cy < 0)
+            return false;
+
+        topology    = Topology(fileTopology);
+        rule        = Rule(birth, survival);
+        randomState = std::string(data.substr(0U, size_t(randomStateSize)));
+        data.remove_prefix(size_t(randomStateSize));
+        if (!Random::IsState(randomState) || !read(&tileNumber, sizeof(tileNumber)) || data.size() / sizeof(Tile) < tileNumber)
+            return false;
+
+        tiles.resize(size_t(tileNumber));
+        read(tiles.data(), tiles.size() * sizeof(Tile));
+        const auto tileNumberX = std::uint32_t((std::max(size.cx, 0) + tileSize - 1) / tileSize);
+        const auto tileNumberY = std::uint32_t((std::max(size.cy, 0) + tileSize - 1) / tileSize);
+        return std::all_of(tiles.begin(), tiles.end(), [=](const Tile& tile) { return tile.x < tileNumberX && tile.y < tileNumberY; });
+    }
+};
+
+#if defined(HASHLIFE)
+using Universe = HashLife;
+#elif defined(SPARSE)
+using Universe = SparseUniverse;
+#endif // HASHLIFE
+
 class Game final
 {
     Random             random    ;
@@ -865,10 +2340,30 @@ class Game final
     unsigned long long generation;
     PatternSet         patternSet;
     int                patternIndex;
+#if defined(HASHLIFE) || defined(SPARSE)
+    Universe           universe;
+#endif // HASHLIFE || SPARSE
+#if defined(TILE)
+    TileSet            tileSet;
+#endif // TILE
+#if defined(MT)
+    ThreadPool         threadPool;
+#endif // MT
 #if defined(AREA) && defined(MT)
     Rect*              areas    ;
-    const unsigned int hardwareConcurrency;
 #endif // AREA && MT
+#if defined(CYCLE)
+    HashHistory        history  ;
+#endif // CYCLE
+#if defined(STATISTICS)
+    Statistics              statistics       ;
+#if defined(MT)
+    std::vector<Statistics> partialStatistics; // one for each worker
+#endif // MT
+#endif // STATISTICS
+#if defined(PROFILE)
+    Profiler           profiler ;
+#endif // PROFILE
 
 public:
     const Board& GetBoard() const
@@ -880,13 +2375,72 @@ public:
     unsigned long long GetGeneration() const
     { return generation; }
 
+#if defined(PROFILE)
+    /// <summary>The timings of the generations computed so far, and of the frames painted with it; Profiler::Clear starts them again.</summary>
+    Profiler& GetProfiler()
+    { return profiler; }
+
+    const Profiler& GetProfiler() const
+    { return profiler; }
+#endif // PROFILE
+
+#if defined(STATISTICS)
+    /// <summary>The statistics of the current generation, counted by the kernel as it computes the generation.</summary>
+    /// <remarks>
+    /// After Advance or NextBlocked, the births and the deaths are since the generation before the current one.
+    /// Before the first generation, and after Reset, SetPattern or Restore, there are no births or deaths.
+    /// Cells set through GetBoard are not counted until the next generation.
+    /// </remarks>
+    const Statistics& GetStatistics() const
+    { return statistics; }
+#endif // STATISTICS
+
+#if defined(CYCLE)
+    /// <returns>The number of generations after which the board repeats, or 0 if it has not repeated yet.</returns>
+    /// <remarks>After NextBlocked or Advance, this may be a multiple of the smallest period.</remarks>
+    unsigned long long GetPeriod() const
+    { return history.GetPeriod(); }
+#endif // CYCLE
+
     tstring GetPatternName() const
-    { return 0 <= patternIndex && patternIndex < patternSet.GetSize() ? patternSet[patternIndex].GetName() : _T(""); }
+    { return 0 <= patternIndex && size_t(patternIndex) < patternSet.GetSize() ? patternSet.GetHeader(size_t(patternIndex)).name : _T(""); }
 
+    /// <returns>The index of the pattern named name, or -1.</returns>
+    int FindPattern(const tstring& name) const
+    {
+        for (size_t index = 0U; index < patternSet.GetSize(); index++) {
+            if (patternSet.GetHeader(index).name == name)
+                return int(index);
+        }
+        return -1;
+    }
+
+    /// <summary>Replaces the patterns with the ones in folderName.</summary>
+    void ReadPatterns(const tstring& folderName)
+    {
+        patternSet.Read(folderName);
+        patternIndex = -1;
+    }
+
+#if defined(MT)
+    /// <param name="workerNumber">The number of threads that compute a generation; 0 means one per hardware thread.</param>
+    Game(const Size& size, unsigned int workerNumber = 0U) : mainBoard(new Board(size)), subBoard(new Board(size)), generation(0UL), patternIndex(-1)
+#if defined(TILE)
+        , tileSet(size)
+#endif // TILE
+        , threadPool(workerNumber)
+#if defined(AREA)
+        , areas(nullptr)
+#endif // AREA
+#if defined(PROFILE)
+        , profiler(threadPool.GetWorkerNumber())
+#endif // PROFILE
+#else // MT
     Game(const Size& size) : mainBoard(new Board(size)), subBoard(new Board(size)), generation(0UL), patternIndex(-1)
-#if defined(AREA) && defined(MT)
-        , areas(nullptr), hardwareConcurrency(ThreadUtility::GetHardwareConcurrency())
-#endif // AREA && MT
+#if defined(TILE)
+        , tileSet(size)
+#endif // TILE
+#endif // MT
     { Initialize(true); }
 
     ~Game()
@@ -900,11 +2454,54 @@ public:
 
     void Next()
     {
+#if defined(HASHLIFE) || defined(SPARSE)
+        Advance(1ULL);
+#else // HASHLIFE || SPARSE
+#if defined(TRACE)
+        const Tracer::Span span("Generation", "generation", Tracer::Argument(generation));
+#endif // TRACE
+#if defined(CYCLE)
+        UpdateHistory();
+#endif // CYCLE
+        {
+#if defined(PROFILE)
+            const Profiler::Scope scope(profiler, Profiler::Phase::Ghosts);
+#endif // PROFILE
+            mainBoard->UpdateGhosts();
+        }
 
+#if defined(TILE)
 #if defined(MT)
+        {
+#if defined(PROFILE)
+            const Profiler::RoundScope roundScope(profiler);
+#endif // PROFILE
+            ThreadUtility::ForEach(threadPool, 0, tileSet.GetTileNumber().cy, [=, this](Integer minimum, Integer maximum, [[maybe_unused]] unsigned int index) {
+#if defined(PROFILE)
+                const Profiler::WorkScope workScope(profiler, index);
+#endif // PROFILE
+                NextTiles(minimum, maximum);
+            });
+        }
+#else // MT
+        {
+#if defined(PROFILE)
+            const Profiler::Scope scope(profiler, Profiler::Phase::Compute);
+#endif // PROFILE
+            NextTiles(0, tileSet.GetTileNumber().cy);
+        }
+#endif // MT
+        {
+#if defined(PROFILE)
+            const Profiler::Scope scope(profiler, Profiler::Phase::Union);
+#endif // PROFILE
+            tileSet.Update(mainBoard->GetTopology() == Topology::Torus);
+        }
+
+#elif defined(MT)
         //const auto size = mainBoard->GetSize();
 
-        //ThreadUtility::ForEach(0, size.cy, [=](Integer minimum, Integer maximum) {
+        //ThreadUtility::ForEach(threadPool, 0, size.cy, [=, this](Integer minimum, Integer maximum) {
         //    NextPart(Point(0, minimum), Point(size.cx, maximum));
         //});
 
@@ -912,41 +2509,347 @@ public:
         const auto areaRightBottom = area.RightBottom();
 
 #if defined(AREA)
-        ResetAreas();
+        {
+#if defined(PROFILE)
+            const Profiler::Scope scope(profiler, Profiler::Phase::Reset);
+#endif // PROFILE
+            ResetAreas();
+        }
 
-        ThreadUtility::ForEach(area.leftTop.y, areaRightBottom.y, [=](Integer minimum, Integer maximum, unsigned int index) {
-            NextPart(Point(area.leftTop.x, minimum), Point(areaRightBottom.x, maximum), areas[index]);
-        });
+        {
+#if defined(PROFILE)
+            const Profiler::RoundScope roundScope(profiler);
+#endif // PROFILE
+            ThreadUtility::ForEach(threadPool, area.leftTop.y, areaRightBottom.y, [=, this](Integer minimum, Integer maximum, unsigned int index) {
+#if defined(PROFILE)
+                const Profiler::WorkScope workScope(profiler, index);
+#endif // PROFILE
+                NextPart(Point(area.leftTop.x, minimum), Point(areaRightBottom.x, maximum), areas[index]);
+#if defined(STATISTICS)
+                partialStatistics[index] = subBoard->GetStatistics(minimum, maximum);
+#endif // STATISTICS
+            });
+        }
 
-        const auto newArea = Rect::Union(areas, hardwareConcurrency);
-        subBoard->SetArea(newArea);
+        {
+#if defined(PROFILE)
+            const Profiler::Scope scope(profiler, Profiler::Phase::Union);
+#endif // PROFILE
+            const auto newArea = Rect::Union(areas, threadPool.GetWorkerNumber());
+            subBoard->SetArea(newArea);
+        }
 
 #else // AREA
-        ThreadUtility::ForEach(area.leftTop.y, areaRightBottom.y, [=](Integer minimum, Integer maximum) {
-            NextPart(Point(area.leftTop.x, minimum), Point(areaRightBottom.x, maximum));
-        });
+        {
+#if defined(PROFILE)
+            const Profiler::RoundScope roundScope(profiler);
+#endif // PROFILE
+            ThreadUtility::ForEach(threadPool, area.leftTop.y, areaRightBottom.y, [=, this](Integer minimum, Integer maximum, [[maybe_unused]] unsigned int index) {
+#if defined(PROFILE)
+                const Profiler::WorkScope workScope(profiler, index);
+#endif // PROFILE
+                NextPart(Point(area.leftTop.x, minimum), Point(areaRightBottom.x, maximum));
+#if defined(STATISTICS)
+                partialStatistics[index] = subBoard->GetStatistics(minimum, maximum);
+#endif // STATISTICS
+            });
+        }
 #endif // AREA
+#if defined(STATISTICS)
+        SumStatistics();
+#endif // STATISTICS
 
 #elif defined(FAST)
         //NextPart(Point(), Point() + mainBoard->GetSize());
         const auto area = mainBoard->GetArea();
-        NextPart(area.leftTop, area.RightBottom());
+        {
+#if defined(PROFILE)
+            const Profiler::Scope scope(profiler, Profiler::Phase::Compute);
+#endif // PROFILE
+            NextPart(area.leftTop, area.RightBottom());
+        }
+#if defined(STATISTICS)
+        statistics = subBoard->GetStatistics(area.leftTop.y, area.RightBottom().y);
+#endif // STATISTICS
 #else // FAST
-        mainBoard->ForEach([&](const Point& point) {
-            const auto aliveNeighborCount = mainBoard->GetAliveNeighborCount(point);
-            const auto alive              = mainBoard->Get(point);
-            subBoard->Set(point, aliveNeighborCount == 3 || (aliveNeighborCount == 2 && alive));
-        });
+        {
+#if defined(PROFILE)
+            const Profiler::Scope scope(profiler, Profiler::Phase::Compute);
+#endif // PROFILE
+            const auto rule = GetRule();
+            mainBoard->ForEach([&](const Point& point) {
+                const auto aliveNeighborCount = mainBoard->GetAliveNeighborCount(point);
+                const auto alive              = mainBoard->Get(point);
+                subBoard->Set(point, rule.IsAlive(alive, aliveNeighborCount));
+            });
+        }
 #endif // FAST
 
 #if defined(_DEBUG)
         Test(*mainBoard);
 #endif // _DEBUG
 
-        std::swap(mainBoard, subBoard);
+        {
+#if defined(PROFILE)
+            const Profiler::Scope scope(profiler, Profiler::Phase::Swap);
+#endif // PROFILE
+            std::swap(mainBoard, subBoard);
+        }
         generation++;
+#if defined(CYCLE)
+        history.Add(mainBoard->GetHash(), generation);
+#endif // CYCLE
+#endif // HASHLIFE || SPARSE
+    }
+
+    /// <summary>Advances generationNumber generations.</summary>
+    /// <remarks>
+    /// With MT and fast loops on a bounded board (and no tiles), the workers are started once for all the generations:
+    /// each keeps a band of rows and waits only for the bands next to it, not for all the workers, at each generation.
+    /// With HASHLIFE, the universe jumps 2^k generations for each bit k of generationNumber, the bits from
+    /// HashLife::maximumLog2Generations up being jumped 2^HashLife::maximumLog2Generations generations at a time; with HASHLIFE or SPARSE,
+    /// the board is rendered once at the end. Otherwise this calls Next generationNumber times.
+    /// </remarks>
+    void Advance(unsigned long long generationNumber)
+    {
+#if defined(TRACE)
+        const Tracer::Span span("Advance", "generations", Tracer::Argument(generationNumber));
+#endif // TRACE
+#if defined(HASHLIFE)
+        {
+#if defined(PROFILE)
+            const Profiler::Scope scope(profiler, Profiler::Phase::Compute);
+#endif // PROFILE
+            constexpr auto maximumLog2Generations = HashLife::maximumLog2Generations;
+            for (auto count = generationNumber >> maximumLog2Generations; count > 0ULL; count--)
+                universe.Advance(maximumLog2Generations);
+            for (auto log2Generations = maximumLog2Generations; log2Generations-- > 0U; ) {
+                if ((generationNumber >> log2Generations) & 1U)
+                    universe.Advance(log2Generations);
+            }
+        }
+        generation += generationNumber;
+        Render();
+#elif defined(SPARSE)
+        {
+#if defined(PROFILE)
+            const Profiler::Scope scope(profiler, Profiler::Phase::Compute);
+#endif // PROFILE
+            for (auto step = 0ULL; step < generationNumber; step++) {
+#if defined(MT)
+                universe.Next([this](KernelImplementation::Index count, auto action) {
+                    ThreadUtility::ForEach(threadPool, 0, Integer(count), [&](Integer minimum, Integer maximum) {
+                        action(KernelImplementation::Index(minimum), KernelImplementation::Index(maximum));
+                    });
+                });
+#else // MT
+                universe.Next();
+#endif // MT
+            }
+        }
+        generation += generationNumber;
+        Render();
+#else // HASHLIFE
+#if defined(FAST) && defined(MT) && !defined(TILE)
+        if (generationNumber > 1ULL && threadPool.GetWorkerNumber() > 1U && Integer(threadPool.GetWorkerNumber()) <= mainBoard->GetSize().cy &&
+            mainBoard->GetTopology() == Topology::Bounded) {
+#if defined(CYCLE)
+            UpdateHistory();
+#endif // CYCLE
+            AdvanceBands(generationNumber);
+#if defined(_DEBUG)
+            Test(*mainBoard);
+#endif // _DEBUG
+            generation += generationNumber;
+#if defined(CYCLE)
+            history.Add(mainBoard->GetHash(), generation);
+#endif // CYCLE
+            return;
+        }
+#endif // FAST && MT && !TILE
+        for (auto count = 0ULL; count < generationNumber; count++)
+            Next();
+#endif // HASHLIFE
+    }
+
+    /// <summary>Advances interval generations at a time with Advance until isDone(*this), which is checked first.</summary>
+    /// <returns>The number of generations advanced.</returns>
+    template <typename TIsDone>
+    unsigned long long AdvanceUntil(TIsDone isDone, unsigned long long interval = 1ULL)
+    {
+        assert(interval > 0ULL);
+
+        const auto  firstGeneration = generation;
+        const Game& game            = *this;
+        while (!isDone(game))
+            Advance(interval);
+        return generation - firstGeneration;
+    }
+
+    /// <summary>Advances depth generations in one sweep over the board, each block of rows staying in cache for all of them.</summary>
+    /// <remarks>
+    /// Temporal blocking needs the 1-bit-per-cell board with fast loops and a bounded board (and no tiles);
+    /// otherwise this calls Next depth times.
+    /// </remarks>
+    void NextBlocked(unsigned int depth)
+    {
+#if defined(USEBITS) && defined(FAST) && !defined(TILE) && !defined(HASHLIFE) && !defined(SPARSE)
+        if (depth > 1U && mainBoard->GetTopology() == Topology::Bounded) {
+#if defined(TRACE)
+            const Tracer::Span span("NextBlocked", "depth", Tracer::Argument(depth));
+#endif // TRACE
+#if defined(CYCLE)
+            UpdateHistory();
+#endif // CYCLE
+            // The cells depth away from the area, and the cells subBoard may still hold, are the ones that can change.
+            const auto size               = mainBoard->GetSize();
+            const auto area               = mainBoard->GetArea();
+            const auto areaRightBottom    = area.RightBottom();
+            const auto subArea            = subBoard->GetArea();
+            const auto subAreaRightBottom = subArea.RightBottom();
+            const auto halo               = Integer(depth);
+            const auto minimum            = Point(std::min(std::max(area.leftTop.x - halo, 0), subArea.leftTop.x),
+                                                  std::min(std::max(area.leftTop.y - halo, 0), subArea.leftTop.y));
+            const auto maximum            = Point(std::max(std::min(areaRightBottom.x + halo, size.cx), subAreaRightBottom.x),
+                                                  std::max(std::min(areaRightBottom.y + halo, size.cy), subAreaRightBottom.y));
+
+#if defined(MT) && defined(AREA)
+            ResetAreas();
+            {
+#if defined(PROFILE)
+                const Profiler::RoundScope roundScope(profiler);
+#endif // PROFILE
+                ThreadUtility::ForEach(threadPool, minimum.y, maximum.y, [=, this](Integer top, Integer bottom, unsigned int index) {
+#if defined(PROFILE)
+                    const Profiler::WorkScope workScope(profiler, index);
+#endif // PROFILE
+                    mainBoard->Next(*subBoard, Point(minimum.x, top), Point(maximum.x, bottom), depth, areas[index]);
+#if defined(STATISTICS)
+                    partialStatistics[index] = subBoard->GetStatistics(top, bottom);
+#endif // STATISTICS
+                });
+            }
+            subBoard->SetArea(Rect::Union(areas, threadPool.GetWorkerNumber()));
+#elif defined(MT)
+            {
+#if defined(PROFILE)
+                const Profiler::RoundScope roundScope(profiler);
+#endif // PROFILE
+                ThreadUtility::ForEach(threadPool, minimum.y, maximum.y, [=, this](Integer top, Integer bottom, [[maybe_unused]] unsigned int index) {
+#if defined(PROFILE)
+                    const Profiler::WorkScope workScope(profiler, index);
+#endif // PROFILE
+                    mainBoard->Next(*subBoard, Point(minimum.x, top), Point(maximum.x, bottom), depth);
+#if defined(STATISTICS)
+                    partialStatistics[index] = subBoard->GetStatistics(top, bottom);
+#endif // STATISTICS
+                });
+            }
+#else // MT && AREA
+            {
+#if defined(PROFILE)
+                const Profiler::Scope scope(profiler, Profiler::Phase::Compute);
+#endif // PROFILE
+#if defined(AREA)
+                auto newArea = area;
+                mainBoard->Next(*subBoard, minimum, maximum, depth, newArea);
+                subBoard->SetArea(newArea);
+#else // AREA
+                mainBoard->Next(*subBoard, minimum, maximum, depth);
+#endif // AREA
+            }
+#endif // MT && AREA
+#if defined(STATISTICS) && defined(MT)
+            SumStatistics();
+#elif defined(STATISTICS)
+            statistics = subBoard->GetStatistics(minimum.y, maximum.y);
+#endif // STATISTICS && MT
+
+#if defined(_DEBUG)
+            Test(*subBoard);
+#endif // _DEBUG
+
+            {
+#if defined(PROFILE)
+                const Profiler::Scope scope(profiler, Profiler::Phase::Swap);
+#endif // PROFILE
+                std::swap(mainBoard, subBoard);
+            }
+            generation += depth;
+#if defined(CYCLE)
+            history.Add(mainBoard->GetHash(), generation);
+#endif // CYCLE
+            return;
+        }
+#endif // USEBITS && FAST && !TILE && !HASHLIFE && !SPARSE
+        for (auto count = 0U; count < depth; count++)
+            Next();
+    }
+
+    /// <summary>Advances to targetGeneration, which must not be before the current generation.</summary>
+    /// <remarks>
+    /// With CYCLE, once the board has repeated, whole periods are skipped and only the rest of the generations are computed.
+    /// The repetition is found from the 64-bit hashes of the boards, not by comparing them, so a skip is only as certain as HashHistory.
+    /// </remarks>
+    void Seek(unsigned long long targetGeneration)
+    {
+        assert(generation <= targetGeneration);
+        while (generation < targetGeneration) {
+#if defined(CYCLE)
+            UpdateHistory();
+            if (const auto period = history.GetPeriod(); period != 0ULL) {
+                generation = targetGeneration - (targetGeneration - generation) % period;
+                if (generation == targetGeneration) {
+#if defined(STATISTICS)
+                    CountStatistics();
+#endif // STATISTICS
+                    break;
+                }
+            }
+#endif // CYCLE
+            Next();
+        }
+    }
+
+    Rule GetRule() const
+    { return mainBoard->GetRule(); }
+
+    /// <remarks>The rule is the one of this Game only; not while a generation is being computed.</remarks>
+    void SetRule(const Rule& rule)
+    {
+        mainBoard->SetRule(rule);
+        subBoard ->SetRule(rule);
+#if defined(CYCLE)
+        history.Clear();
+#endif // CYCLE
+#if defined(HASHLIFE) || defined(SPARSE)
+        universe.SetRule(rule);
+#endif // HASHLIFE || SPARSE
+#if defined(TILE)
+        tileSet.SetAll();
+#endif // TILE
     }
 
+#if defined(HASHLIFE) || defined(SPARSE)
+    const Universe& GetUniverse() const
+    { return universe; }
+#else // HASHLIFE || SPARSE
+    Topology GetTopology() const
+    { return mainBoard->GetTopology(); }
+
+    void SetTopology(Topology topology)
+    {
+        mainBoard->SetTopology(topology);
+        subBoard ->SetTopology(topology);
+#if defined(TILE)
+        tileSet.SetAll();
+#endif // TILE
+#if defined(CYCLE)
+        history.Clear();
+#endif // CYCLE
+    }
+#endif // HASHLIFE || SPARSE
+
     void Reset(bool randomize)
     {
         Initialize(randomize);
@@ -955,29 +2858,202 @@ public:
             patternIndex = -1;
     }
 
-    bool SetPattern(int index)
+    /// <summary>Clears the board and places the pattern index at its center, turned to orientation.</summary>
+    bool SetPattern(int index, Orientation orientation = Orientation::Identity)
     {
-        if (index < 0 || patternSet.GetSize() <= index) {
+        if (index < 0 || patternSet.GetSize() <= size_t(index)) {
+            patternIndex = -1;
+            return false;
+        }
+#if defined(HASHLIFE)
+        if (Macrocell macrocell; orientation == Orientation::Identity && patternSet.Get(size_t(index), macrocell)) {
+            universe.Set(macrocell); // the tree as it is, however many cells it has
+            Render();
+            SetRule(macrocell.GetRule());
+            patternIndex = index;
+            return true;
+        }
+#endif // HASHLIFE
+        auto pattern = patternSet.Get(size_t(index));
+        if (pattern->GetSize() == Size()) { // the file could not be read, or its rule is not supported
+            patternIndex = -1;
+            return false;
+        }
+        if (orientation != Orientation::Identity)
+            pattern = std::make_shared<const Pattern>(pattern->Transform(orientation));
+#if defined(HASHLIFE) || defined(SPARSE)
+        universe.Set(*pattern);
+        Render();
+#else // HASHLIFE || SPARSE
+        if (!mainBoard->Set(*pattern)) {
             patternIndex = -1;
             return false;
         }
-        mainBoard->Set(patternSet[index]);
-        subBoard ->Set(patternSet[index]);
+        subBoard->Set(*pattern);
+#endif // HASHLIFE || SPARSE
+        SetRule(pattern->GetRule());
+#if defined(TILE)
+        tileSet.SetAll();
+#endif // TILE
+#if defined(STATISTICS)
+        CountStatistics();
+#endif // STATISTICS
         patternIndex = index;
         return true;
     }
 
+    /// <summary>Writes the cells in the Macrocell format, each distinct subtree once.</summary>
+    /// <remarks>
+    /// With HASHLIFE, this writes the whole universe. Otherwise this writes the board with its center at the origin, as Load puts it
+    /// into a universe (with SPARSE, the part of the universe on the board), and the subtrees outside the area are not visited.
+    /// </remarks>
+    void WriteMacrocell(std::ostream& stream)
+    {
+#if defined(TRACE)
+        const Tracer::Span span("WriteMacrocell");
+#endif // TRACE
+#if defined(HASHLIFE)
+        universe.Write(stream);
+#else // HASHLIFE
+        const auto size  = mainBoard->GetSize();
+        auto       level = Macrocell::leafLevel + 1U;
+        while ((Integer(1) << (level - 1U)) < std::max(size.cx - size.cx / 2, size.cy - size.cy / 2))
+            level++;
+
+        const auto        half = Integer(1) << (level - 1U);
+        Macrocell::Writer writer(stream, GetRule());
+        writer.End(level, WriteMacrocell(writer, level, Point(size.cx / 2 - half, size.cy / 2 - half)));
+#endif // HASHLIFE
+    }
+
+    /// <summary>Writes the alive cells of the board, within their bounds, in the RLE format with the rule.</summary>
+    /// <remarks>The board is read a unit of 64 cells at a time and the runs go straight to stream, so the memory does not grow with the board.</remarks>
+    void WriteRle(std::ostream& stream) const
+    {
+#if defined(TRACE)
+        const Tracer::Span span("WriteRle");
+#endif // TRACE
+        const auto getRow = GetRowGetter();
+        PatternWriter::WriteRle(stream, getRow, PatternWriter::GetBounds(getRow, mainBoard->GetArea(), mainBoard->GetSize().cx), GetRule());
+    }
+
+    /// <summary>Writes the alive cells of the board, within their bounds, in the Life 1.05 format with the rule.</summary>
+    void WriteLife(std::ostream& stream) const
+    {
+#if defined(TRACE)
+        const Tracer::Span span("WriteLife");
+#endif // TRACE
+        const auto getRow = GetRowGetter();
+        PatternWriter::WriteLife(stream, getRow, PatternWriter::GetBounds(getRow, mainBoard->GetArea(), mainBoard->GetSize().cx), GetRule());
+    }
+
+#if !defined(HASHLIFE) && !defined(SPARSE)
+    /// <summary>Takes a checkpoint of the game, copying only the tiles in the area that have alive cells.</summary>
+    /// <remarks>Not with HASHLIFE or SPARSE, as a checkpoint holds only the board and their universe reaches beyond it; WriteMacrocell saves the universe of HashLife.</remarks>
+    Checkpoint GetCheckpoint() const
+    {
+        Checkpoint checkpoint;
+        checkpoint.size        = mainBoard->GetSize();
+        checkpoint.topology    = mainBoard->GetTopology();
+        checkpoint.generation  = generation;
+        checkpoint.area        = mainBoard->GetArea();
+        checkpoint.rule        = GetRule();
+        checkpoint.randomState = random.GetState();
+
+        const auto size            = checkpoint.size;
+        const auto tileSize        = Checkpoint::tileSize;
+        const auto bits            = mainBoard->GetBits();
+        const auto stride          = mainBoard->GetBitsStride() / UnsignedInteger(sizeof(UnitInteger));
+        const auto lastUnitMask    = size.cx % tileSize == 0 ? ~UnitInteger(0) : (UnitInteger(1) << (size.cx % tileSize)) - 1U;
+        const auto area            = checkpoint.area;
+        const auto areaRightBottom = area.RightBottom();
+        for (auto tileY = area.leftTop.y / tileSize; tileY * tileSize < areaRightBottom.y; tileY++) {
+            for (auto tileX = area.leftTop.x / tileSize; tileX * tileSize < areaRightBottom.x; tileX++) {
+                const auto         mask  = (tileX + 1) * tileSize > size.cx ? lastUnitMask : ~UnitInteger(0);
+                Checkpoint::Tile   tile  = { std::uint32_t(tileX), std::uint32_t(tileY), {} };
+                UnitInteger        alive = 0U;
+                for (auto y = 0; y < tileSize && tileY * tileSize + y < size.cy; y++) {
+                    tile.rows[y]  = bits[stride * UnsignedInteger(tileY * tileSize + y) + UnsignedInteger(tileX)] & mask;
+                    alive        |= tile.rows[y];
+                }
+                if (alive != 0U)
+                    checkpoint.tiles.push_back(tile);
+            }
+        }
+        return checkpoint;
+    }
+
+    /// <summary>Restores a checkpoint, in time proportional to its tiles.</summary>
+    /// <returns>false if the checkpoint is of a board of another size, or its state of Random is not one Random::GetState returned.</returns>
+    bool Restore(const Checkpoint& checkpoint)
+    {
+        const auto size = mainBoard->GetSize();
+        if (!(checkpoint.size == size) || !Random::IsState(checkpoint.randomState))
+            return false;
+
+        const auto tileSize = Checkpoint::tileSize;
+        for (auto board : { mainBoard, subBoard }) {
+            board->Clear();
+            for (const auto& tile : checkpoint.tiles) {
+                const auto leftTop     = Point(Integer(tile.x) * tileSize, Integer(tile.y) * tileSize);
+                const auto patternSize = Size(std::min(tileSize, size.cx - leftTop.x), std::min(tileSize, size.cy - leftTop.y));
+                const auto mask        = patternSize.cx == tileSize ? ~UnitInteger(0) : (UnitInteger(1) << patternSize.cx) - 1U;
+
+                std::vector<UnitInteger> rows(tile.rows, tile.rows + patternSize.cy);
+                for (auto& row : rows)
+                    row &= mask;
+                board->Place(Pattern(_T(""), patternSize, std::move(rows)), leftTop);
+            }
+#if defined(AREA)
+            board->SetArea(checkpoint.area);
+#endif // AREA
+        }
+
+        SetTopology(checkpoint.topology);
+        SetRule(checkpoint.rule);
+        random.SetState(checkpoint.randomState);
+        generation   = checkpoint.generation;
+        patternIndex = -1;
+#if defined(TILE)
+        tileSet.SetAll();
+#endif // TILE
+#if defined(CYCLE)
+        history.Clear();
+#endif // CYCLE
+#if defined(STATISTICS)
+        CountStatistics();
+#endif // STATISTICS
+        return true;
+    }
+#endif // !HASHLIFE && !SPARSE
+
 private:
     void Initialize(bool randomize)
     {
-        if (randomize)
+        if (randomize) {
             Randomize();
+#if defined(HASHLIFE) || defined(SPARSE)
+            Load();
+#endif // HASHLIFE || SPARSE
+        }
+#if defined(TILE)
+        tileSet.SetAll();
+#endif // TILE
+#if defined(CYCLE)
+        history.Clear();
+#endif // CYCLE
 
 #if defined(AREA) && defined(MT)
         delete[] areas;
-        areas = new Rect[hardwareConcurrency];
+        areas = new Rect[threadPool.GetWorkerNumber()];
         ResetAreas();
 #endif // AREA && MT
+#if defined(STATISTICS)
+#if defined(MT)
+        partialStatistics.assign(threadPool.GetWorkerNumber(), Statistics());
+#endif // MT
+        CountStatistics();
+#endif // STATISTICS
     }
 
     void Randomize()
@@ -996,39 +3072,286 @@ private:
 #endif // FAST
     }
 
+#if defined(HASHLIFE) || defined(SPARSE)
+    /// <remarks>The center of the board is the origin of the universe.</remarks>
+    void Load()
+    {
+        const auto size = mainBoard->GetSize();
+        universe.Set(size.cx, size.cy, GetRowGetter());
+    }
+
+    void Render()
+    {
+        const auto size = mainBoard->GetSize();
+        mainBoard->Clear();
+        universe.ForEachAlive(-size.cx / 2, -size.cy / 2, size.cx, size.cy, [&](Universe::Coordinate x, Universe::Coordinate y) {
+            mainBoard->Set(Point(Integer(x + size.cx / 2), Integer(y + size.cy / 2)), true);
+        });
+    }
+#endif // HASHLIFE || SPARSE
+
+    /// <summary>A function that gets a row of the board as units of 64 cells.</summary>
+    std::function<const UnitInteger*(Integer)> GetRowGetter() const
+    {
+        const auto bits   = mainBoard->GetBits();
+        const auto stride = mainBoard->GetBitsStride() / UnsignedInteger(sizeof(UnitInteger));
+        return [=](Integer y) { return bits + stride * UnsignedInteger(y); };
+    }
+
+#if !defined(HASHLIFE)
+    /// <returns>The number in the file of the node of level with its left top cell at leftTop on the board, or 0 if it is empty.</returns>
+    size_t WriteMacrocell(Macrocell::Writer& writer, unsigned int level, const Point& leftTop) const
+    {
+        const auto nodeSize        = Integer(1) << level;
+        const auto area            = mainBoard->GetArea();
+        const auto areaRightBottom = area.RightBottom();
+        if (leftTop.x >= areaRightBottom.x || leftTop.y >= areaRightBottom.y || leftTop.x + nodeSize <= area.leftTop.x || leftTop.y + nodeSize <= area.leftTop.y)
+            return 0U;
+
+        if (level == Macrocell::leafLevel) {
+            Macrocell::Leaf leaf = 0U;
+            for (auto y = 0; y < nodeSize; y++) {
+                for (auto x = 0; x < nodeSize; x++) {
+                    if (mainBoard->Get(Point(leftTop.x + x, leftTop.y + y)))
+                        leaf |= Macrocell::Leaf(1) << (y * nodeSize + x);
+                }
+            }
+            return writer.AddLeaf(leaf);
+        }
+
+        const auto half = nodeSize / 2;
+        const auto nw   = WriteMacrocell(writer, level - 1U, leftTop                                );
+        const auto ne   = WriteMacrocell(writer, level - 1U, Point(leftTop.x + half, leftTop.y       ));
+        const auto sw   = WriteMacrocell(writer, level - 1U, Point(leftTop.x       , leftTop.y + half));
+        const auto se   = WriteMacrocell(writer, level - 1U, Point(leftTop.x + half, leftTop.y + half));
+        return writer.AddNode(level, nw, ne, sw, se);
+    }
+#endif // HASHLIFE
+
+#if defined(CYCLE)
+    /// <summary>Starts the history with the board, unless the board is still the one of the last generation.</summary>
+    /// <remarks>A board changed from outside through GetBoard() starts the history again.</remarks>
+    void UpdateHistory()
+    {
+        const auto hash = mainBoard->GetHash();
+        if (!history.IsEmpty() && history.GetLastHash() == hash)
+            return;
+        history.Clear();
+        history.Add(hash, generation);
+    }
+#endif // CYCLE
+
 #if defined(AREA) && defined(MT)
     void ResetAreas()
     {
-        for (auto index = 0U; index < hardwareConcurrency; index++)
+        for (auto index = 0U; index < threadPool.GetWorkerNumber(); index++)
             areas[index] = mainBoard->GetArea();
     }
 #endif // AREA && MT
 
+#if defined(STATISTICS)
+    void CountStatistics()
+    {
+        const auto area = mainBoard->GetArea();
+        statistics      = mainBoard->Count(area.leftTop.y, area.RightBottom().y);
+    }
+
+#if defined(MT)
+    void SumStatistics()
+    {
+        statistics = Statistics();
+        for (const auto& partial : partialStatistics)
+            statistics.Add(partial);
+    }
+#endif // MT
+#endif // STATISTICS
+
+#if defined(TILE)
+    void NextTiles(Integer minimum, Integer maximum)
+    {
+        for (auto tileY = minimum; tileY < maximum; tileY++)
+            mainBoard->Next(*subBoard, tileY, tileSet.GetActive(tileY), tileSet.GetChanged(tileY));
+    }
+#endif // TILE
+
+#if defined(FAST) && defined(MT) && !defined(TILE) && !defined(HASHLIFE) && !defined(SPARSE)
+    /// <summary>Advances generationNumber generations of a bounded board in one run of the workers, each on a band of rows.</summary>
+    /// <remarks>
+    /// The board needs a row for each worker. Worker i computes generation g + 1 of its band once the bands i - 1 and i + 1
+    /// have got to generation g, so a worker is never a generation ahead of its neighbors, and mainBoard and subBoard take turns
+    /// by the parity of g.
+    /// With AREA, each band keeps its area for the two parities; its next area starts from its own area, so that it never shrinks,
+    /// and a band computes only its rows in the union of its area and the areas of its neighbors, as the other cells stay dead.
+    /// </remarks>
+    void AdvanceBands(unsigned long long generationNumber)
+    {
+        struct alignas(64) Band final
+        {
+            Integer                         top;
+            Integer                         bottom;
+#if defined(AREA)
+            Rect                            areas[2];
+#endif // AREA
+#if defined(STATISTICS)
+            Statistics                      statistics; // of the last generation
+#endif // STATISTICS
+            std::atomic<unsigned long long> progress; // the generations done
+        };
+
+        const auto workerNumber = threadPool.GetWorkerNumber();
+        const auto size         = mainBoard->GetSize();
+#if defined(AREA)
+        // subBoard may still hold cells out of the area of mainBoard.
+        const Rect boardAreas[] = { mainBoard->GetArea(), subBoard->GetArea() };
+        const auto area         = Rect::Union(boardAreas, 2U);
+#else // AREA
+        const auto area         = Rect(Point(), size);
+#endif // AREA
+
+        // The rows of the area, at least one per band, are split evenly; the first and the last bands reach the edges of the board.
+        // A band reads only the rows next to it then, so it needs to wait for its neighbors only.
+        const auto splitHeight = std::max(area.size.cy, Integer(workerNumber));
+        const auto splitTop    = std::min(area.leftTop.y, size.cy - splitHeight);
+        std::vector<Band> bands(workerNumber);
+        for (auto index = 0U; index < workerNumber; index++) {
+            auto& band  = bands[index];
+            band.top    = index == 0U                ? 0       : splitTop + splitHeight * Integer(index     ) / Integer(workerNumber);
+            band.bottom = index == workerNumber - 1U ? size.cy : splitTop + splitHeight * Integer(index + 1U) / Integer(workerNumber);
+#if defined(AREA)
+            band.areas[0] = band.areas[1] = area;
+#endif // AREA
+        }
+
+        Board* const boards[] = { mainBoard, subBoard };
+#if defined(PROFILE)
+        const auto roundBegin = Profiler::Now();
+#endif // PROFILE
+        threadPool.Run([&](unsigned int index) {
+            auto& band = bands[index];
+            for (auto count = 0ULL; count < generationNumber; count++) {
+                const auto parity = size_t(count % 2U);
+#if defined(AREA)
+                Rect       neighborAreas[3] = { band.areas[parity], band.areas[parity], band.areas[parity] };
+#endif // AREA
+                for (const auto neighbor : { index - 1U, index + 1U }) {
+                    if (neighbor >= workerNumber)
+                        continue;
+                    threadPool.Wait(bands[neighbor].progress, [count](unsigned long long progress) { return progress >= count; });
+#if defined(AREA)
+                    neighborAreas[neighbor < index ? 1 : 2] = bands[neighbor].areas[parity];
+#endif // AREA
+                }
+
+#if defined(AREA)
+                const auto region            = Rect::Union(neighborAreas, 3U);
+                const auto regionRightBottom = region.RightBottom();
+                const auto top               = std::max(band.top   , region.leftTop.y   );
+                const auto bottom            = std::min(band.bottom, regionRightBottom.y);
+                auto       nextArea          = band.areas[parity];
+                if (top < bottom) {
+#if defined(PROFILE)
+                    const Profiler::WorkScope workScope(profiler, index);
+#endif // PROFILE
+#if defined(TRACE)
+                    const Tracer::Span span("Band", "generation", Tracer::Argument(generation + count));
+#endif // TRACE
+                    boards[parity]->Next(*boards[1U - parity], Point(region.leftTop.x, top), Point(regionRightBottom.x, bottom), nextArea);
+                }
+                band.areas[1U - parity] = nextArea;
+#else // AREA
+                const auto top    = band.top;
+                const auto bottom = band.bottom;
+                {
+#if defined(PROFILE)
+                    const Profiler::WorkScope workScope(profiler, index);
+#endif // PROFILE
+#if defined(TRACE)
+                    const Tracer::Span span("Band", "generation", Tracer::Argument(generation + count));
+#endif // TRACE
+                    boards[parity]->Next(*boards[1U - parity], Point(0, top), Point(size.cx, bottom));
+                }
+#endif // AREA
+#if defined(STATISTICS)
+                if (count + 1ULL == generationNumber)
+                    band.statistics = boards[1U - parity]->GetStatistics(top, bottom);
+#endif // STATISTICS
+
+                band.progress.store(count + 1ULL, std::memory_order_release);
+                band.progress.notify_all();
+            }
+        });
+#if defined(PROFILE)
+        profiler.EndRound(Profiler::GetNanoseconds(roundBegin, Profiler::Now()));
+#endif // PROFILE
+
+#if defined(AREA)
+        {
+#if defined(PROFILE)
+            const Profiler::Scope scope(profiler, Profiler::Phase::Union);
+#endif // PROFILE
+            // The board of each parity gets the union of the areas of the bands.
+            std::vector<Rect> bandAreas(workerNumber);
+            for (const auto parity : { 0U, 1U }) {
+                std::transform(bands.begin(), bands.end(), bandAreas.begin(), [parity](const Band& band) { return band.areas[parity]; });
+                boards[parity]->SetArea(Rect::Union(bandAreas.data(), workerNumber));
+            }
+        }
+#endif // AREA
+#if defined(STATISTICS)
+        statistics = Statistics();
+        for (const auto& band : bands)
+            statistics.Add(band.statistics);
+#endif // STATISTICS
+        if (generationNumber % 2U == 1U) {
+#if defined(PROFILE)
+            const Profiler::Scope scope(profiler, Profiler::Phase::Swap);
+#endif // PROFILE
+            std::swap(mainBoard, subBoard);
+        }
+    }
+#endif // FAST && MT && !TILE && !HASHLIFE && !SPARSE
+
 #if defined(AREA) && defined(MT)
     void NextPart(const Point& minimum, const Point& maximum, Rect& area)
     {
+#if defined(FAST)
+        mainBoard->Next(*subBoard, minimum, maximum, area);
+#else // FAST
+        const auto rule = GetRule();
         Point point;
         for (point.y = minimum.y; point.y < maximum.y; point.y++) {
             for (point.x = minimum.x; point.x < maximum.x; point.x++) {
                 const auto aliveNeighborCount = mainBoard->GetAliveNeighborCount(point);
-                const auto alive              = aliveNeighborCount == 3 || (aliveNeighborCount == 2 && mainBoard->Get(point));
+                const auto alive              = rule.IsAlive(mainBoard->Get(point), aliveNeighborCount);
                 subBoard->SetOnly(point, alive);
 
                 if (alive)
                     area = BitCellSet::Union(area, mainBoard->GetRect(), point);
             }
         }
+#endif // FAST
     }
 #elif defined(FAST) || defined(MT)
     void NextPart(const Point& minimum, const Point& maximum)
     {
+#if defined(FAST)
+#if defined(AREA)
+        auto area = subBoard->GetArea();
+        mainBoard->Next(*subBoard, minimum, maximum, area);
+        subBoard->SetArea(area);
+#else // AREA
+        mainBoard->Next(*subBoard, minimum, maximum);
+#endif // AREA
+#else // FAST
+        const auto rule = GetRule();
         Point point;
         for (point.y = minimum.y; point.y < maximum.y; point.y++) {
             for (point.x = minimum.x; point.x < maximum.x; point.x++) {
                 const auto aliveNeighborCount = mainBoard->GetAliveNeighborCount(point);
-                subBoard->Set(point, aliveNeighborCount == 3 || (aliveNeighborCount == 2 && mainBoard->Get(point)));
+                subBoard->Set(point, rule.IsAlive(mainBoard->Get(point), aliveNeighborCount));
             }
         }
+#endif // FAST
     }
 #endif // FAST
 
@@ -12,11 +12,32 @@ class BoardPainter final
 public:
     static void Paint(HDC deviceContextHandle, const POINT& position, Board& board)
     {
+#if defined(TRACE)
+        const Tracer::Span span("Frame");
+#endif // TRACE
         const auto bitmapHandle = CreateBitmap(board);
         Paint(deviceContextHandle, position, { board.GetSize().cx, board.GetSize().cy }, bitmapHandle);
         ::DeleteObject(bitmapHandle);
     }
 
+#if defined(PROFILE)
+    /// <summary>Paints as above, adding the time to make a bitmap of the bits of the board to Bits, and the time to paint them to Paint.</summary>
+    static void Paint(HDC deviceContextHandle, const POINT& position, Board& board, Profiler& profiler)
+    {
+#if defined(TRACE)
+        const Tracer::Span span("Frame");
+#endif // TRACE
+        const auto bitsBegin    = Profiler::Now();
+        const auto bitmapHandle = CreateBitmap(board);
+        const auto paintBegin   = Profiler::Now();
+        profiler.Add(Profiler::Phase::Bits, Profiler::GetNanoseconds(bitsBegin, paintBegin));
+
+        Paint(deviceContextHandle, position, { board.GetSize().cx, board.GetSize().cy }, bitmapHandle);
+        ::DeleteObject(bitmapHandle);
+        profiler.Add(Profiler::Phase::Paint, Profiler::GetNanoseconds(paintBegin, Profiler::Now()));
+    }
+#endif // PROFILE
+
 private:
     static HBITMAP CreateBitmap(Board& board)
     {
@@ -25,9 +46,9 @@ private:
         bitmap.bmWidth      = board.GetSize().cx;
         bitmap.bmHeight     = board.GetSize().cy;
         bitmap.bmPlanes     = 1;
-        bitmap.bmWidthBytes = board.GetSize().cx / sizeof(Byte);
         bitmap.bmBitsPixel  = 1;
         bitmap.bmBits       = board.GetBits();
+        bitmap.bmWidthBytes = board.GetBitsStride();
 
         return ::CreateBitmapIndirect(&bitmap);
     }
@@ -0,0 +1,553 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cassert>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <unordered_map>
+#include <ostream>
+#include "ShosLifeGameRule.h"
+#include "ShosLifeGameMacrocell.h"
+
+namespace Shos::LifeGame {
+
+/// <summary>An unbounded universe stepped with Gosper's HashLife algorithm.</summary>
+/// <remarks>
+/// The universe is a quadtree whose nodes are canonicalized through a hash table, so that identical subtrees are shared,
+/// and each node memoizes its RESULT: its center half advanced by the current step.
+/// A result keeps the step it was made for, so a change of step makes only the results of the nodes above the step again.
+/// The node cache is bounded; unreachable nodes are collected between steps once it is full.
+/// </remarks>
+class HashLife final
+{
+public:
+    using Coordinate = long long;
+
+    static constexpr unsigned int maximumLevel           = 62;
+    static constexpr unsigned int maximumLog2Generations = maximumLevel - 4U; // the root is expanded to 3 levels above the step, and once more
+
+private:
+    using Unit = std::uint64_t; // 64 cells of a row, bit n being the n-th cell from the left
+
+    struct Node final
+    {
+        Node*              nw;
+        Node*              ne;
+        Node*              sw;
+        Node*              se;
+        Node*              result;
+        Node*              next;       // next node in the same hash bucket, or in the free list
+        unsigned long long population;
+        unsigned int       level;      // a node of level n is 2^n cells square
+        bool               marked;
+        std::uint8_t       resultStep; // the log2 of the generations result is advanced
+    };
+
+    static constexpr size_t       nodeBlockSize      = 1 << 16;
+    static constexpr unsigned int unitLevel          = 6;  // a node of this level is a unit wide
+    static constexpr Coordinate   unitSize           = Coordinate(1) << unitLevel;
+
+    std::vector<std::unique_ptr<Node[]>> nodeBlocks;
+    Node*                                freeNodes;
+    std::vector<Node*>                   buckets;
+    size_t                               nodeNumber;
+    size_t                               maximumNodeNumber;
+    Node                                 deadCell;
+    Node                                 aliveCell;
+    std::vector<Node*>                   emptyNodes;
+    Node*                                root;
+    unsigned int                         stepLevel;     // results advance min(2^stepLevel, 2^(level - 2)) generations
+    Rule                                 rule;
+
+public:
+    /// <param name="maximumNodeNumber">The number of nodes above which garbage is collected before the next step.</param>
+    HashLife(size_t maximumNodeNumber = size_t(1) << 22)
+        : freeNodes(nullptr), buckets(size_t(1) << 16, nullptr), nodeNumber(0U), maximumNodeNumber(maximumNodeNumber)
+        , deadCell(), aliveCell(), root(nullptr), stepLevel(0U)
+    {
+        aliveCell.population = 1U;
+        Clear();
+    }
+
+    HashLife(const HashLife&)            = delete;
+    HashLife& operator=(const HashLife&) = delete;
+
+    Rule GetRule() const
+    { return rule; }
+
+    /// <remarks>Forgets every memoized result, as they depend on the rule.</remarks>
+    void SetRule(const Rule& rule)
+    {
+        if (rule == this->rule)
+            return;
+        this->rule = rule;
+        ClearResults();
+    }
+
+    size_t GetNodeNumber() const
+    { return nodeNumber; }
+
+    unsigned long long GetPopulation() const
+    { return root->population; }
+
+    void Clear()
+    { root = GetEmptyNode(3U); }
+
+    bool Get(Coordinate x, Coordinate y) const
+    {
+        const auto half = GetHalf(root->level);
+        if (x < -half || half <= x || y < -half || half <= y)
+            return false;
+        return Get(root, x + half, y + half);
+    }
+
+    void Set(Coordinate x, Coordinate y, bool value)
+    {
+        while (!IsIn(root->level, x, y) && root->level < maximumLevel)
+            root = Expand(root);
+
+        const auto half = GetHalf(root->level);
+        root            = Set(root, x + half, y + half, value);
+    }
+
+    /// <summary>Places the pattern so that its center is at the origin.</summary>
+    template <typename TPattern>
+    void Set(const TPattern& pattern)
+    {
+        const auto size = pattern.GetSize();
+        Set(size.cx, size.cy, [&](auto y) { return pattern.GetRow(y); });
+    }
+
+    /// <summary>Replaces the universe with width x height cells, their center at the origin.</summary>
+    /// <param name="getRow">getRow(y) returns the row y as units of 64 cells, bit n of a unit being its n-th cell from the left.</param>
+    /// <remarks>The leaves are made of the bytes of the units and joined bottom-up, as Macrocell::Build does, so no cell is set on its own.</remarks>
+    template <typename TGetRow>
+    void Set(Coordinate width, Coordinate height, TGetRow getRow)
+    {
+        auto level = unitLevel;
+        while (GetHalf(level) < std::max(width - width / 2, height - height / 2))
+            level++;
+        root = Build(level, width / 2 - GetHalf(level), height / 2 - GetHalf(level), width, height, getRow);
+    }
+
+    /// <summary>Replaces the universe with a Macrocell pattern, the center of its root at the origin.</summary>
+    /// <remarks>Each node of the file is joined once, so the cells are never expanded.</remarks>
+    void Set(const Macrocell& macrocell)
+    {
+        root = macrocell.Build<Node*>([this](Macrocell::Leaf leaf) { return ToNode(leaf, 0U, 0U, Macrocell::leafLevel); },
+                                      [this](Node* nw, Node* ne, Node* sw, Node* se) { return Join(nw, ne, sw, se); },
+                                      [this](unsigned int level) { return GetEmptyNode(level); });
+    }
+
+    /// <summary>Writes the universe in the Macrocell format, with the center of the root at the origin.</summary>
+    /// <remarks>The nodes are shared already, so each distinct subtree is written once.</remarks>
+    void Write(std::ostream& stream)
+    {
+        Macrocell::Writer                       writer(stream, rule);
+        std::unordered_map<const Node*, size_t> numbers;
+        const auto                              node = root->level > Macrocell::leafLevel ? root : Expand(root);
+        writer.End(node->level, Write(writer, node, numbers));
+    }
+
+    /// <summary>Advances the universe 2^log2Generations generations.</summary>
+    /// <remarks>log2Generations must not be above maximumLog2Generations.</remarks>
+    void Advance(unsigned int log2Generations)
+    {
+        assert(log2Generations <= maximumLog2Generations);
+
+        if (nodeNumber > maximumNodeNumber)
+            CollectGarbage();
+
+        stepLevel = log2Generations;
+
+        while (root->level < stepLevel + 3U || !IsBorderEmpty(root))
+            root = Expand(root);
+        root = Successor(Expand(root));
+
+        while (root->level > 3U && IsBorderEmpty(root))
+            root = GetCenter(root);
+    }
+
+    /// <summary>Calls setCell(x, y) for each live cell in [left, left + width) x [top, top + height).</summary>
+    template <typename TSetCell>
+    void ForEachAlive(Coordinate left, Coordinate top, Coordinate width, Coordinate height, TSetCell setCell) const
+    {
+        const auto half = GetHalf(root->level);
+        ForEachAlive(root, -half, -half, left, top, left + width, top + height, setCell);
+    }
+
+    /// <summary>Frees the nodes that are no longer reachable from the universe.</summary>
+    void CollectGarbage()
+    {
+        Mark(root, true);
+        Sweep();
+
+        if (nodeNumber > maximumNodeNumber / 2) {
+            ClearResults();
+            Mark(root, false);
+            Sweep();
+        }
+    }
+
+private:
+    static Coordinate GetHalf(unsigned int level)
+    { return level == 0U ? 0 : Coordinate(1) << (level - 1U); }
+
+    static bool IsIn(unsigned int level, Coordinate x, Coordinate y)
+    {
+        const auto half = GetHalf(level);
+        return -half <= x && x < half && -half <= y && y < half;
+    }
+
+    static bool Get(const Node* node, Coordinate x, Coordinate y)
+    {
+        while (node->level > 0U) {
+            if (node->population == 0U)
+                return false;
+            const auto half = GetHalf(node->level);
+            node = y < half ? (x < half ? node->nw : node->ne) : (x < half ? node->sw : node->se);
+            x   %= half;
+            y   %= half;
+        }
+        return node->population != 0U;
+    }
+
+    Node* Set(Node* node, Coordinate x, Coordinate y, bool value)
+    {
+        if (node->level == 0U)
+            return value ? &aliveCell : &deadCell;
+
+        const auto half = GetHalf(node->level);
+        if (y < half) {
+            return x < half ? Join(Set(node->nw, x, y, value), node->ne, node->sw, node->se)
+                            : Join(node->nw, Set(node->ne, x - half, y, value), node->sw, node->se);
+        }
+        return x < half ? Join(node->nw, node->ne, Set(node->sw, x, y - half, value), node->se)
+                        : Join(node->nw, node->ne, node->sw, Set(node->se, x - half, y - half, value));
+    }
+
+    template <typename TSetCell>
+    static void ForEachAlive(const Node* node, Coordinate nodeLeft, Coordinate nodeTop, Coordinate left, Coordinate top, Coordinate right, Coordinate bottom, TSetCell& setCell)
+    {
+        const auto size = Coordinate(1) << node->level;
+        if (node->population == 0U || nodeLeft >= right || nodeTop >= bottom || nodeLeft + size <= left || nodeTop + size <= top)
+            return;
+
+        if (node->level == 0U) {
+            setCell(nodeLeft, nodeTop);
+            return;
+        }
+
+        const auto half = size / 2;
+        ForEachAlive(node->nw, nodeLeft       , nodeTop       , left, top, right, bottom, setCell);
+        ForEachAlive(node->ne, nodeLeft + half, nodeTop       , left, top, right, bottom, setCell);
+        ForEachAlive(node->sw, nodeLeft       , nodeTop + half, left, top, right, bottom, setCell);
+        ForEachAlive(node->se, nodeLeft + half, nodeTop + half, left, top, right, bottom, setCell);
+    }
+
+    /// <summary>The node of level for the cells of leaf from (x, y).</summary>
+    Node* ToNode(Macrocell::Leaf leaf, unsigned int x, unsigned int y, unsigned int level)
+    {
+        if (level == 0U)
+            return (leaf >> (y * 8U + x) & 1U) != 0U ? &aliveCell : &deadCell;
+
+        const auto half = 1U << (level - 1U);
+        return Join(ToNode(leaf, x, y       , level - 1U), ToNode(leaf, x + half, y       , level - 1U),
+                    ToNode(leaf, x, y + half, level - 1U), ToNode(leaf, x + half, y + half, level - 1U));
+    }
+
+    /// <summary>The node of level with its left top cell at (left, top) of the width x height cells getRow returns.</summary>
+    template <typename TGetRow>
+    Node* Build(unsigned int level, Coordinate left, Coordinate top, Coordinate width, Coordinate height, TGetRow& getRow)
+    {
+        const auto size = Coordinate(1) << level;
+        if (left >= width || top >= height || left + size <= 0 || top + size <= 0)
+            return GetEmptyNode(level);
+
+        if (level > unitLevel) {
+            const auto half = size / 2;
+            return Join(Build(level - 1U, left, top       , width, height, getRow), Build(level - 1U, left + half, top       , width, height, getRow),
+                        Build(level - 1U, left, top + half, width, height, getRow), Build(level - 1U, left + half, top + half, width, height, getRow));
+        }
+
+        Unit units[unitSize] = {};
+        for (auto y = std::max(-top, Coordinate(0)); y < unitSize && top + y < height; y++)
+            units[y] = GetUnit(getRow(top + y), width, left);
+        return ToNode(units, 0U, 0U, unitLevel);
+    }
+
+    /// <summary>The node of level for the cells of units, 64 rows of 64 cells, from (x, y).</summary>
+    Node* ToNode(const Unit* units, unsigned int x, unsigned int y, unsigned int level)
+    {
+        if (level == Macrocell::leafLevel) {
+            Macrocell::Leaf leaf = 0U;
+            for (auto row = 0U; row < 8U; row++)
+                leaf |= (units[y + row] >> x & 0xFFU) << (row * 8U);
+            return leaf == 0U ? GetEmptyNode(level) : ToNode(leaf, 0U, 0U, level);
+        }
+
+        const auto half = 1U << (level - 1U);
+        return Join(ToNode(units, x, y       , level - 1U), ToNode(units, x + half, y       , level - 1U),
+                    ToNode(units, x, y + half, level - 1U), ToNode(units, x + half, y + half, level - 1U));
+    }
+
+    /// <summary>The 64 cells of a row of width cells from x on; x may be off the row.</summary>
+    static Unit GetUnit(const Unit* row, Coordinate width, Coordinate x)
+    {
+        if (x >= width || x + unitSize <= 0)
+            return 0U;
+
+        const auto index = x >> unitLevel;
+        const auto shift = x & (unitSize - 1);
+        const auto low   = index >= 0 ? row[index] : Unit(0);
+        const auto high  = shift != 0 && (index + 1) * unitSize < width ? row[index + 1] : Unit(0);
+        auto       unit  = shift == 0 ? low : low >> shift | high << (unitSize - shift);
+        if (width - x < unitSize)
+            unit &= (Unit(1) << (width - x)) - 1U;
+        return unit;
+    }
+
+    static Macrocell::Leaf ToLeaf(const Node* node)
+    {
+        Macrocell::Leaf leaf = 0U;
+        for (auto y = 0; y < 8; y++) {
+            for (auto x = 0; x < 8; x++) {
+                if (Get(node, x, y))
+                    leaf |= Macrocell::Leaf(1) << (y * 8 + x);
+            }
+        }
+        return leaf;
+    }
+
+    /// <returns>The number of node in the file, or 0 if it is empty.</returns>
+    static size_t Write(Macrocell::Writer& writer, const Node* node, std::unordered_map<const Node*, size_t>& numbers)
+    {
+        if (node->population == 0U)
+            return 0U;
+        if (const auto iterator = numbers.find(node); iterator != numbers.end())
+            return iterator->second;
+
+        const auto number = node->level == Macrocell::leafLevel
+                          ? writer.AddLeaf(ToLeaf(node))
+                          : writer.AddNode(node->level, Write(writer, node->nw, numbers), Write(writer, node->ne, numbers),
+                                                        Write(writer, node->sw, numbers), Write(writer, node->se, numbers));
+        numbers.emplace(node, number);
+        return number;
+    }
+
+    Node* GetEmptyNode(unsigned int level)
+    {
+        while (emptyNodes.size() <= level)
+            emptyNodes.push_back(emptyNodes.empty() ? &deadCell : Join(emptyNodes.back(), emptyNodes.back(), emptyNodes.back(), emptyNodes.back()));
+        return emptyNodes[level];
+    }
+
+    /// <summary>Surrounds node with an empty border, keeping its center where it was.</summary>
+    Node* Expand(Node* node)
+    {
+        const auto empty = GetEmptyNode(node->level - 1U);
+        return Join(Join(empty   , empty   , empty   , node->nw),
+                    Join(empty   , empty   , node->ne, empty   ),
+                    Join(empty   , node->sw, empty   , empty   ),
+                    Join(node->se, empty   , empty   , empty   ));
+    }
+
+    /// <summary>Whether every live cell is in the center half of node.</summary>
+    static bool IsBorderEmpty(const Node* node)
+    {
+        return node->population == node->nw->se->population + node->ne->sw->population +
+                                   node->sw->ne->population + node->se->nw->population;
+    }
+
+    Node* GetCenter(const Node* node)
+    { return Join(node->nw->se, node->ne->sw, node->sw->ne, node->se->nw); }
+
+    Node* GetHorizontalCenter(const Node* west, const Node* east)
+    { return Join(west->ne, east->nw, west->se, east->sw); }
+
+    Node* GetVerticalCenter(const Node* north, const Node* south)
+    { return Join(north->sw, north->se, south->nw, south->ne); }
+
+    /// <summary>The center half of node advanced min(2^stepLevel, 2^(level - 2)) generations.</summary>
+    Node* Successor(Node* node)
+    {
+        const auto step = std::min(stepLevel, node->level - 2U);
+        if (node->result != nullptr && node->resultStep == step)
+            return node->result;
+
+        Node* result;
+        if (node->population == 0U) {
+            result = GetEmptyNode(node->level - 1U);
+        } else if (node->level == 2U) {
+            result = NextCenter(node);
+        } else {
+            Node* const parts[3][3] = {
+                { node->nw                                , GetHorizontalCenter(node->nw, node->ne), node->ne                                },
+                { GetVerticalCenter(node->nw, node->sw)   , GetCenter(node)                        , GetVerticalCenter(node->ne, node->se)   },
+                { node->sw                                , GetHorizontalCenter(node->sw, node->se), node->se                                }
+            };
+            Node* steps[3][3];
+            for (auto y = 0; y < 3; y++) {
+                for (auto x = 0; x < 3; x++)
+                    steps[y][x] = Successor(parts[y][x]);
+            }
+
+            const auto fullStep = stepLevel + 2U >= node->level;
+            Node*      quarters[2][2];
+            for (auto y = 0; y < 2; y++) {
+                for (auto x = 0; x < 2; x++) {
+                    const auto quarter = Join(steps[y][x], steps[y][x + 1], steps[y + 1][x], steps[y + 1][x + 1]);
+                    quarters[y][x]     = fullStep ? Successor(quarter) : GetCenter(quarter);
+                }
+            }
+            result = Join(quarters[0][0], quarters[0][1], quarters[1][0], quarters[1][1]);
+        }
+        node->result     = result;
+        node->resultStep = std::uint8_t(step);
+        return result;
+    }
+
+    /// <summary>The center 2x2 cells of a 4x4 node one generation later.</summary>
+    Node* NextCenter(const Node* node)
+    {
+        unsigned int bits = 0U;
+        for (auto y = 0; y < 4; y++) {
+            for (auto x = 0; x < 4; x++) {
+                if (Get(node, x, y))
+                    bits |= 1U << (y * 4 + x);
+            }
+        }
+
+        Node* cells[2][2];
+        for (auto y = 1; y <= 2; y++) {
+            for (auto x = 1; x <= 2; x++) {
+                auto count = 0U;
+                for (auto dy = -1; dy <= 1; dy++) {
+                    for (auto dx = -1; dx <= 1; dx++) {
+                        if ((dx != 0 || dy != 0) && (bits & (1U << ((y + dy) * 4 + x + dx))) != 0U)
+                            count++;
+                    }
+                }
+                const auto alive       = (bits & (1U << (y * 4 + x))) != 0U;
+                cells[y - 1][x - 1] = rule.IsAlive(alive, count) ? &aliveCell : &deadCell;
+            }
+        }
+        return Join(cells[0][0], cells[0][1], cells[1][0], cells[1][1]);
+    }
+
+    /// <summary>The canonical node with the four children.</summary>
+    Node* Join(Node* nw, Node* ne, Node* sw, Node* se)
+    {
+        auto& bucket = buckets[GetHash(nw, ne, sw, se) & (buckets.size() - 1U)];
+        for (auto node = bucket; node != nullptr; node = node->next) {
+            if (node->nw == nw && node->ne == ne && node->sw == sw && node->se == se)
+                return node;
+        }
+
+        auto node        = NewNode();
+        node->nw         = nw;
+        node->ne         = ne;
+        node->sw         = sw;
+        node->se         = se;
+        node->result     = nullptr;
+        node->population = nw->population + ne->population + sw->population + se->population;
+        node->level      = nw->level + 1U;
+        node->marked     = false;
+        node->next       = bucket;
+        bucket           = node;
+
+        if (++nodeNumber > buckets.size())
+            Rehash();
+        return node;
+    }
+
+    static size_t GetHash(const Node* nw, const Node* ne, const Node* sw, const Node* se)
+    {
+        auto hash = reinterpret_cast<std::uintptr_t>(nw);
+        hash      = hash * 0x9e3779b97f4a7c15ULL + reinterpret_cast<std::uintptr_t>(ne);
+        hash      = hash * 0x9e3779b97f4a7c15ULL + reinterpret_cast<std::uintptr_t>(sw);
+        hash      = hash * 0x9e3779b97f4a7c15ULL + reinterpret_cast<std::uintptr_t>(se);
+        return size_t(hash ^ (hash >> 29));
+    }
+
+    Node* NewNode()
+    {
+        if (freeNodes == nullptr) {
+            nodeBlocks.emplace_back(new Node[nodeBlockSize]);
+            auto block = nodeBlocks.back().get();
+            for (size_t index = 0U; index < nodeBlockSize; index++) {
+                block[index].next = freeNodes;
+                freeNodes         = &block[index];
+            }
+        }
+        auto node = freeNodes;
+        freeNodes = node->next;
+        return node;
+    }
+
+    void Rehash()
+    {
+        std::vector<Node*> newBuckets(buckets.size() * 2U, nullptr);
+        ForEachNode([&](Node* node) {
+            auto& bucket = newBuckets[GetHash(node->nw, node->ne, node->sw, node->se) & (newBuckets.size() - 1U)];
+            node->next   = bucket;
+            bucket       = node;
+        });
+        buckets.swap(newBuckets);
+    }
+
+    template <typename TAction>
+    void ForEachNode(TAction action)
+    {
+        for (auto& bucket : buckets) {
+            for (auto node = bucket; node != nullptr;) {
+                const auto next = node->next;
+                action(node);
+                node = next;
+            }
+        }
+    }
+
+    void ClearResults()
+    { ForEachNode([](Node* node) { node->result = nullptr; }); }
+
+    static void Mark(Node* node, bool withResults)
+    {
+        if (node->level == 0U || node->marked)
+            return;
+
+        node->marked = true;
+        Mark(node->nw, withResults);
+        Mark(node->ne, withResults);
+        Mark(node->sw, withResults);
+        Mark(node->se, withResults);
+        if (withResults && node->result != nullptr)
+            Mark(node->result, withResults);
+    }
+
+    void Sweep()
+    {
+        for (auto empty : emptyNodes)
+            Mark(empty, false);
+
+        for (auto& bucket : buckets) {
+            Node** link = &bucket;
+            while (*link != nullptr) {
+                auto node = *link;
+                if (node->marked) {
+                    node->marked = false;
+                    link         = &node->next;
+                } else {
+                    *link      = node->next;
+                    node->next = freeNodes;
+                    freeNodes  = node;
+                    nodeNumber--;
+                }
+            }
+        }
+    }
+};
+
+} // namespace Shos::LifeGame
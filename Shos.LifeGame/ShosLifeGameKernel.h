@@ -0,0 +1,423 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include "ShosLifeGameRule.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define KERNEL_X86 // x86 instruction sets available
+#endif // _M_X64 || _M_IX86 || __x86_64__ || __i386__
+
+#if defined(SIMD) && defined(KERNEL_X86)
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else // _MSC_VER
+#include <cpuid.h>
+#endif // _MSC_VER
+#endif // SIMD && KERNEL_X86
+
+namespace Shos::LifeGame {
+
+enum class InstructionSet
+{
+    Scalar,
+    Sse2  ,
+    Avx2  ,
+    Avx512
+};
+
+namespace KernelImplementation {
+
+using Unit  = std::uint64_t;
+using Index = unsigned int ;
+
+constexpr Index bitNumber = sizeof(Unit) * 8;
+
+/// <summary>The alive cells of a row, the cells born and died in it since the generation before, and the bounds [left, right) of its alive cells.</summary>
+struct RowCount final
+{
+    Index population;
+    Index births;
+    Index deaths;
+    Index left;
+    Index right; // left and right are 0 if no cell is alive
+};
+
+namespace Scalar {
+
+using Vector = Unit;
+
+constexpr Index vectorUnitNumber = 1;
+
+inline Vector Zero ()                           { return 0U             ; }
+inline Vector Ones ()                           { return ~Unit(0)       ; }
+inline Vector Load (const Unit* unit)           { return *unit          ; }
+inline void   Store(Unit* unit, Vector vector) { *unit = vector        ; }
+inline Vector And   (Vector a, Vector b)        { return a & b          ; }
+inline Vector AndNot(Vector a, Vector b)        { return ~a & b         ; }
+inline Vector Or    (Vector a, Vector b)        { return a | b          ; }
+inline Vector Xor   (Vector a, Vector b)        { return a ^ b          ; }
+template <int N>
+inline Vector ShiftLeft (Vector vector)         { return vector << N    ; }
+template <int N>
+inline Vector ShiftRight(Vector vector)         { return vector >> N    ; }
+
+#include "ShosLifeGameKernel.inl"
+
+} // namespace Scalar
+
+// The engine of the rules without a kernel of their own: it takes any rule, but is far slower than the bit-sliced kernels.
+namespace Table {
+
+using Table = std::array<std::uint8_t, 512>;
+
+/// <summary>Builds the next state of the center cell of every 3x3 neighborhood under rule.</summary>
+/// <remarks>Bits 0-2 of an index are the row above, 3-5 the row and 6-8 the row below, each from left to right.</remarks>
+constexpr Table CreateTable(const Rule& rule)
+{
+    Table table {};
+    for (Index index = 0; index < Index(table.size()); index++) {
+        const auto alive = ((index >> 4) & 1U) != 0U;
+        table[index]     = std::uint8_t(rule.IsAlive(alive, Index(std::popcount(index)) - (alive ? 1U : 0U)));
+    }
+    return table;
+}
+
+/// <summary>Gets the index into a table of the cells shift to shift + 2 of the three rows.</summary>
+inline Index GetIndex(const Unit rows[3], Index shift)
+{ return Index(((rows[0] >> shift) & 7U) | (((rows[1] >> shift) & 7U) << 3) | (((rows[2] >> shift) & 7U) << 6)); }
+
+/// <returns>end, as every unit is computed.</returns>
+/// <remarks>Branch free and without SIMD: one lookup in a 512-byte table per cell.</remarks>
+inline Index NextRow(const Table& table, const Unit* center, Index stride, Unit* next, Index begin, Index end)
+{
+    for (auto index = begin; index < end; index++) {
+        // Bit x of low is cell x - 1, for the cells 0 to 61; bit x of high is cell x + 61, for the cells 62 and 63.
+        Unit low[3], high[3];
+        for (auto row = 0; row < 3; row++) {
+            const auto unit = center + index + (row - 1) * std::ptrdiff_t(stride);
+            low [row]       = (unit[0] << 1) | (unit[-1] >> (bitNumber - 1));
+            high[row]       = (unit[0] >> (bitNumber - 3)) | (unit[1] << 3);
+        }
+
+        Unit nextUnit = 0U;
+        for (Index x = 0; x < bitNumber - 2; x++)
+            nextUnit |= Unit(table[GetIndex(low, x)]) << x;
+        for (Index x = bitNumber - 2; x < bitNumber; x++)
+            nextUnit |= Unit(table[GetIndex(high, x - (bitNumber - 2))]) << x;
+        next[index] = nextUnit;
+    }
+    return end;
+}
+
+} // namespace Table
+
+#if defined(SIMD) && defined(KERNEL_X86)
+// GCC and Clang need the instruction set of each namespace enabled on its functions; MSVC allows every intrinsic anywhere.
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("sse2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("sse2")
+#endif // __clang__
+
+namespace Sse2 {
+
+using Vector = __m128i;
+
+constexpr Index vectorUnitNumber = sizeof(Vector) / sizeof(Unit);
+
+inline Vector Zero ()                           { return _mm_setzero_si128()                                     ; }
+inline Vector Ones ()                           { return _mm_set1_epi32(-1)                                      ; }
+inline Vector Load (const Unit* unit)           { return _mm_loadu_si128(reinterpret_cast<const Vector*>(unit)); }
+inline void   Store(Unit* unit, Vector vector) { _mm_storeu_si128(reinterpret_cast<Vector*>(unit), vector)   ; }
+inline Vector And   (Vector a, Vector b)        { return _mm_and_si128   (a, b)                                  ; }
+inline Vector AndNot(Vector a, Vector b)        { return _mm_andnot_si128(a, b)                                  ; }
+inline Vector Or    (Vector a, Vector b)        { return _mm_or_si128    (a, b)                                  ; }
+inline Vector Xor   (Vector a, Vector b)        { return _mm_xor_si128   (a, b)                                  ; }
+template <int N>
+inline Vector ShiftLeft (Vector vector)         { return _mm_slli_epi64(vector, N)                              ; }
+template <int N>
+inline Vector ShiftRight(Vector vector)         { return _mm_srli_epi64(vector, N)                              ; }
+
+#include "ShosLifeGameKernel.inl"
+
+} // namespace Sse2
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif // __clang__
+
+namespace Avx2 {
+
+using Vector = __m256i;
+
+constexpr Index vectorUnitNumber = sizeof(Vector) / sizeof(Unit);
+
+inline Vector Zero ()                           { return _mm256_setzero_si256()                                     ; }
+inline Vector Ones ()                           { return _mm256_set1_epi32(-1)                                      ; }
+inline Vector Load (const Unit* unit)           { return _mm256_loadu_si256(reinterpret_cast<const Vector*>(unit)); }
+inline void   Store(Unit* unit, Vector vector) { _mm256_storeu_si256(reinterpret_cast<Vector*>(unit), vector)   ; }
+inline Vector And   (Vector a, Vector b)        { return _mm256_and_si256   (a, b)                                  ; }
+inline Vector AndNot(Vector a, Vector b)        { return _mm256_andnot_si256(a, b)                                  ; }
+inline Vector Or    (Vector a, Vector b)        { return _mm256_or_si256    (a, b)                                  ; }
+inline Vector Xor   (Vector a, Vector b)        { return _mm256_xor_si256   (a, b)                                  ; }
+template <int N>
+inline Vector ShiftLeft (Vector vector)         { return _mm256_slli_epi64(vector, N)                              ; }
+template <int N>
+inline Vector ShiftRight(Vector vector)         { return _mm256_srli_epi64(vector, N)                              ; }
+
+#include "ShosLifeGameKernel.inl"
+
+} // namespace Avx2
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#pragma clang attribute push(__attribute__((target("avx512f"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+#endif // __clang__
+
+namespace Avx512 {
+
+using Vector = __m512i;
+
+constexpr Index vectorUnitNumber = sizeof(Vector) / sizeof(Unit);
+
+// The zero-masking forms with every lane selected: GCC writes the unmasked ones on an uninitialized vector, which -Wmaybe-uninitialized reports.
+constexpr __mmask8 allLanes = 0xFF;
+
+inline Vector Zero ()                           { return _mm512_setzero_si512()                    ; }
+inline Vector Ones ()                           { return _mm512_set1_epi32(-1)                     ; }
+inline Vector Load (const Unit* unit)           { return _mm512_loadu_si512(unit)                  ; }
+inline void   Store(Unit* unit, Vector vector) { _mm512_storeu_si512(unit, vector)                ; }
+inline Vector And   (Vector a, Vector b)        { return _mm512_and_si512   (a, b)                 ; }
+inline Vector AndNot(Vector a, Vector b)        { return _mm512_maskz_andnot_epi64(allLanes, a, b) ; }
+inline Vector Or    (Vector a, Vector b)        { return _mm512_or_si512    (a, b)                 ; }
+inline Vector Xor   (Vector a, Vector b)        { return _mm512_xor_si512   (a, b)                 ; }
+template <int N>
+inline Vector ShiftLeft (Vector vector)         { return _mm512_maskz_slli_epi64(allLanes, vector, N); }
+template <int N>
+inline Vector ShiftRight(Vector vector)         { return _mm512_maskz_srli_epi64(allLanes, vector, N); }
+
+#include "ShosLifeGameKernel.inl"
+
+} // namespace Avx512
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif // __clang__
+#endif // SIMD && KERNEL_X86
+
+} // namespace KernelImplementation
+
+/// <summary>Picks the code that computes rows of the next generation: the widest instruction set the CPU supports, and a kernel for a rule.</summary>
+/// <remarks>
+/// The instruction set is detected once, through CPUID, on first use.
+/// Common rules have kernels of their own, and any other rule is looked up in a table; RuleKernel keeps the choice for a rule,
+/// so each board has its own rule.
+/// </remarks>
+class Kernel final
+{
+    using Unit          = KernelImplementation::Unit ;
+    using Index         = KernelImplementation::Index;
+    using RowCount      = KernelImplementation::RowCount;
+    using Table         = KernelImplementation::Table::Table;
+    using CountFunction = RowCount (*)(const Unit* center, const Unit* next, Index begin, Index end, Unit lastUnitMask);
+
+public:
+    /// <remarks>table is the table of the rule, used only by a rule without a kernel of its own.</remarks>
+    using RowFunction   = void (*)(const Table& table, const Unit* center, Index stride, Unit* next, Index begin, Index end);
+    using RowFunctions  = std::array<RowFunction, size_t(InstructionSet::Avx512) + 1U>; // one for each instruction set
+
+    static InstructionSet GetInstructionSet()
+    { return Current(); }
+
+    static const char* GetInstructionSetName()
+    { return GetName(GetInstructionSet()); }
+
+    static const char* GetName(InstructionSet instructionSet)
+    {
+        switch (instructionSet) {
+        case InstructionSet::Sse2  : return "SSE2"   ;
+        case InstructionSet::Avx2  : return "AVX2"   ;
+        case InstructionSet::Avx512: return "AVX-512";
+        default                    : return "Scalar" ;
+        }
+    }
+
+    /// <summary>Uses instructionSet, or the widest supported one below it.</summary>
+    /// <remarks>Not while a generation is being computed.</remarks>
+    static void SetInstructionSet(InstructionSet instructionSet)
+    {
+        Current() = std::min(instructionSet, Detect());
+        Count()   = SelectCount(Current());
+    }
+
+    /// <summary>Picks the kernels of rule, for each instruction set.</summary>
+    /// <remarks>A rule without kernels of its own needs the table Table::CreateTable makes of it.</remarks>
+    static RowFunctions Select(const Rule& rule)
+    {
+        RowFunctions rows {};
+        for (size_t index = 0U; index < rows.size(); index++)
+            rows[index] = Select(InstructionSet(index), rule);
+        return rows;
+    }
+
+    /// <summary>Counts the units [begin, end) of next, the row after center, with the popcount of the current instruction set.</summary>
+    /// <remarks>Only the cells in lastUnitMask of the unit end - 1 are counted.</remarks>
+    static RowCount CountRow(const Unit* center, const Unit* next, Index begin, Index end, Unit lastUnitMask)
+    { return Count()(center, next, begin, end, lastUnitMask); }
+
+private:
+    static InstructionSet& Current()
+    {
+        static InstructionSet instructionSet = Detect();
+        return instructionSet;
+    }
+
+    static CountFunction& Count()
+    {
+        static CountFunction count = SelectCount(Current());
+        return count;
+    }
+
+    template <std::uint16_t birth, std::uint16_t survival, typename TVectorRow>
+    static void NextRow(TVectorRow vectorRow, const Unit* center, Index stride, Unit* next, Index begin, Index end)
+    {
+        const auto index = vectorRow(center, stride, next, begin, end);
+        KernelImplementation::Scalar::NextRow<birth, survival>(center, stride, next, index, end);
+    }
+
+    static RowFunction Select(InstructionSet instructionSet, const Rule& rule)
+    {
+        if (rule == Rule::Conway     ()) return Select<Rule::Conway     ().GetBirth(), Rule::Conway     ().GetSurvival()>(instructionSet);
+        if (rule == Rule::HighLife   ()) return Select<Rule::HighLife   ().GetBirth(), Rule::HighLife   ().GetSurvival()>(instructionSet);
+        if (rule == Rule::DayAndNight()) return Select<Rule::DayAndNight().GetBirth(), Rule::DayAndNight().GetSurvival()>(instructionSet);
+        if (rule == Rule::Seeds      ()) return Select<Rule::Seeds      ().GetBirth(), Rule::Seeds      ().GetSurvival()>(instructionSet);
+
+        return [](const Table& table, const Unit* center, Index stride, Unit* next, Index begin, Index end) { KernelImplementation::Table::NextRow(table, center, stride, next, begin, end); };
+    }
+
+    template <std::uint16_t birth, std::uint16_t survival>
+    static RowFunction Select(InstructionSet instructionSet)
+    {
+        switch (instructionSet) {
+#if defined(SIMD) && defined(KERNEL_X86)
+        case InstructionSet::Sse2  : return [](const Table&, const Unit* center, Index stride, Unit* next, Index begin, Index end) { NextRow<birth, survival>(KernelImplementation::Sse2  ::NextRow<birth, survival>, center, stride, next, begin, end); };
+        case InstructionSet::Avx2  : return [](const Table&, const Unit* center, Index stride, Unit* next, Index begin, Index end) { NextRow<birth, survival>(KernelImplementation::Avx2  ::NextRow<birth, survival>, center, stride, next, begin, end); };
+        case InstructionSet::Avx512: return [](const Table&, const Unit* center, Index stride, Unit* next, Index begin, Index end) { NextRow<birth, survival>(KernelImplementation::Avx512::NextRow<birth, survival>, center, stride, next, begin, end); };
+#endif // SIMD && KERNEL_X86
+        default                    : return [](const Table&, const Unit* center, Index stride, Unit* next, Index begin, Index end) { KernelImplementation::Scalar::NextRow<birth, survival>(center, stride, next, begin, end); };
+        }
+    }
+
+    static CountFunction SelectCount(InstructionSet instructionSet)
+    {
+        switch (instructionSet) {
+#if defined(SIMD) && defined(KERNEL_X86)
+        case InstructionSet::Sse2  : return KernelImplementation::Sse2  ::CountRow;
+        case InstructionSet::Avx2  : return KernelImplementation::Avx2  ::CountRow;
+        case InstructionSet::Avx512: return KernelImplementation::Avx512::CountRow;
+#endif // SIMD && KERNEL_X86
+        default                    : return KernelImplementation::Scalar::CountRow;
+        }
+    }
+
+    static InstructionSet Detect()
+    {
+#if defined(SIMD) && defined(KERNEL_X86)
+        int registers[4];
+        CpuId(0, registers);
+        const auto maximumLeaf = registers[0];
+
+        CpuId(1, registers);
+        if ((registers[3] & (1 << 26)) == 0)                                        // SSE2
+            return InstructionSet::Scalar;
+
+        const auto osxsave = (registers[2] & (1 << 27)) != 0;
+        const auto avx     = (registers[2] & (1 << 28)) != 0;
+        if (maximumLeaf < 7 || !osxsave || !avx)
+            return InstructionSet::Sse2;
+
+        const auto xcr0 = GetXcr0();
+        if ((xcr0 & 0x06) != 0x06)                                                  // XMM and YMM states saved by the OS
+            return InstructionSet::Sse2;
+
+        CpuId(7, registers);
+        if ((registers[1] & (1 << 16)) != 0 && (xcr0 & 0xe0) == 0xe0)               // AVX512F, and opmask and ZMM states
+            return InstructionSet::Avx512;
+        if ((registers[1] & (1 << 5)) != 0)                                         // AVX2
+            return InstructionSet::Avx2;
+        return InstructionSet::Sse2;
+#else // SIMD && KERNEL_X86
+        return InstructionSet::Scalar;
+#endif // SIMD && KERNEL_X86
+    }
+
+#if defined(SIMD) && defined(KERNEL_X86)
+    static void CpuId(int leaf, int registers[4])
+    {
+#if defined(_MSC_VER)
+        __cpuidex(registers, leaf, 0);
+#else // _MSC_VER
+        unsigned int eax, ebx, ecx, edx;
+        __cpuid_count(leaf, 0, eax, ebx, ecx, edx);
+        registers[0] = int(eax);
+        registers[1] = int(ebx);
+        registers[2] = int(ecx);
+        registers[3] = int(edx);
+#endif // _MSC_VER
+    }
+
+    static unsigned long long GetXcr0()
+    {
+#if defined(_MSC_VER)
+        return _xgetbv(0);
+#else // _MSC_VER
+        unsigned int eax, edx;
+        __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+        return (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif // _MSC_VER
+    }
+#endif // SIMD && KERNEL_X86
+};
+
+/// <summary>A rule with the kernels Kernel picked for it, and its table if it has no kernels of its own.</summary>
+/// <remarks>A value, so that each board computes under its own rule; it is read only while a generation is computed.</remarks>
+class RuleKernel final
+{
+    using Unit  = KernelImplementation::Unit ;
+    using Index = KernelImplementation::Index;
+
+    Rule                               rule ;
+    Kernel::RowFunctions               rows ;
+    KernelImplementation::Table::Table table;
+
+public:
+    RuleKernel(const Rule& rule = Rule()) : rule(rule), rows(Kernel::Select(rule)), table(KernelImplementation::Table::CreateTable(rule))
+    {}
+
+    const Rule& GetRule() const
+    { return rule; }
+
+    /// <summary>Writes the units [begin, end) of the row after center to next, with the current instruction set.</summary>
+    /// <remarks>center must have readable units at -1 and end, and at stride before and after it.</remarks>
+    void NextRow(const Unit* center, Index stride, Unit* next, Index begin, Index end) const
+    { rows[size_t(Kernel::GetInstructionSet())](table, center, stride, next, begin, end); }
+};
+
+} // namespace Shos::LifeGame
@@ -0,0 +1,153 @@
+// The word-parallel generation kernel.
+// This file has no include guard: ShosLifeGameKernel.h includes it once per instruction set,
+// inside a namespace that defines Vector, vectorUnitNumber, Zero, Ones, Load, Store, And, AndNot, Or, Xor, ShiftLeft and ShiftRight.
+
+/// <summary>Sums each cell and its left and right neighbors, as the 2-bit number (sum1, sum0).</summary>
+inline void SumRow(const Unit* unit, Vector& sum0, Vector& sum1)
+{
+    const auto center = Load(unit);
+    const auto left   = Or(ShiftLeft <1>(center), ShiftRight<bitNumber - 1>(Load(unit - 1)));
+    const auto right  = Or(ShiftRight<1>(center), ShiftLeft <bitNumber - 1>(Load(unit + 1)));
+    const auto half   = Xor(left, right);
+    sum0              = Xor(half, center);
+    sum1              = Or(And(left, right), And(half, center));
+}
+
+/// <summary>Computes the next state of the cells in *center with bitwise full adders.</summary>
+/// <remarks>With the cell itself counted, a cell is alive next if the 3x3 sum is 3, or 4 and the cell is alive.</remarks>
+inline Vector NextVector(const Unit* center, Index stride)
+{
+    Vector up0, up1, center0, center1, down0, down1;
+    SumRow(center - stride, up0    , up1    );
+    SumRow(center         , center0, center1);
+    SumRow(center + stride, down0  , down1  );
+
+    // sum = sum0 + 2 * sum1 + 4 * sum2 (sums of 8 or 9 leave sum1 and sum2 zero and are never alive)
+    const auto sum0  = Xor(Xor(up0, center0), down0);
+    const auto carry = Or(And(up0, center0), And(down0, Xor(up0, center0)));
+    const auto half1 = Xor(up1, center1);
+    const auto half2 = Xor(down1, carry);
+    const auto sum1  = Xor(half1, half2);
+    const auto sum2  = Xor(Xor(And(up1, center1), And(down1, carry)), And(half1, half2));
+
+    const auto three = AndNot(sum2, And(sum0, sum1));
+    const auto four  = And(AndNot(Or(sum0, sum1), sum2), Load(center));
+    return Or(three, four);
+}
+
+/// <summary>Counts the eight neighbors of each cell as the 4-bit number (count[3], count[2], count[1], count[0]).</summary>
+inline void CountNeighbors(const Unit* center, Index stride, Vector count[4])
+{
+    Vector up0, up1, down0, down1;
+    SumRow(center - stride, up0  , up1  );
+    SumRow(center + stride, down0, down1);
+
+    const auto centerUnit = Load(center);
+    const auto left       = Or(ShiftLeft <1>(centerUnit), ShiftRight<bitNumber - 1>(Load(center - 1)));
+    const auto right      = Or(ShiftRight<1>(centerUnit), ShiftLeft <bitNumber - 1>(Load(center + 1)));
+    const auto center0    = Xor(left, right);
+    const auto center1    = And(left, right);
+
+    // Adds the three 2-bit sums: the ones, then the twos with the carry from the ones.
+    const auto half0  = Xor(up0, center0);
+    count[0]          = Xor(half0, down0);
+    const auto carry0 = Or(And(up0, center0), And(half0, down0));
+    const auto half1  = Xor(up1, center1);
+    const auto sum1   = Xor(half1, down1);
+    const auto carry1 = Or(And(up1, center1), And(half1, down1));
+    count[1]          = Xor(sum1, carry0);
+    const auto carry2 = And(sum1, carry0);
+    count[2]          = Xor(carry1, carry2);
+    count[3]          = And(carry1, carry2);
+}
+
+/// <summary>Selects the cells whose neighbor count is value.</summary>
+template <Index value>
+inline Vector Equal(const Vector count[4])
+{
+    auto equal = Ones();
+    for (Index bit = 0; bit < 4; bit++)
+        equal = ((value >> bit) & 1U) != 0U ? And(equal, count[bit]) : AndNot(count[bit], equal);
+    return equal;
+}
+
+/// <summary>Selects the cells that are alive next under the rule (birth, survival), for the neighbor counts from value to 8.</summary>
+template <std::uint16_t birth, std::uint16_t survival, Index value = 0>
+inline Vector Apply(const Vector count[4], Vector alive)
+{
+    if constexpr (value > 8) {
+        return Zero();
+    } else {
+        const auto     rest     = Apply<birth, survival, value + 1>(count, alive);
+        constexpr bool born     = ((birth    >> value) & 1U) != 0U;
+        constexpr bool survives = ((survival >> value) & 1U) != 0U;
+        if constexpr (!born && !survives)
+            return rest;
+        else if constexpr (born && survives)
+            return Or(rest, Equal<value>(count));
+        else if constexpr (born)
+            return Or(rest, AndNot(alive, Equal<value>(count)));
+        else
+            return Or(rest, And(alive, Equal<value>(count)));
+    }
+}
+
+/// <summary>Computes the next state of the cells in *center under the rule (birth, survival).</summary>
+/// <remarks>The rule is known at compile time, so only the terms of its neighbor counts are computed; B3/S23 uses the shorter NextVector above.</remarks>
+template <std::uint16_t birth, std::uint16_t survival>
+inline Vector NextVector(const Unit* center, Index stride)
+{
+    if constexpr (Rule(birth, survival) == Rule::Conway()) {
+        return NextVector(center, stride);
+    } else {
+        Vector count[4];
+        CountNeighbors(center, stride, count);
+        return Apply<birth, survival>(count, Load(center));
+    }
+}
+
+/// <returns>The first unit in [begin, end) that is left for a narrower kernel.</returns>
+template <std::uint16_t birth, std::uint16_t survival>
+inline Index NextRow(const Unit* center, Index stride, Unit* next, Index begin, Index end)
+{
+    auto index = begin;
+    for (; index + vectorUnitNumber <= end; index += vectorUnitNumber)
+        Store(next + index, NextVector<birth, survival>(center + index, stride));
+    return index;
+}
+
+/// <summary>Counts the units [begin, end) of next, the row after center, a popcount per unit.</summary>
+/// <remarks>
+/// Only the cells in lastUnitMask of the unit end - 1 are counted, so that the padding bits after a row are not.
+/// The code is the same for every instruction set; built with AVX2 or AVX-512 enabled, a popcount is one instruction.
+/// </remarks>
+inline RowCount CountRow(const Unit* center, const Unit* next, Index begin, Index end, Unit lastUnitMask)
+{
+    RowCount count {};
+    if (begin >= end)
+        return count;
+
+    const auto add = [&](Unit unit, Unit previous) {
+        count.population += Index(std::popcount(unit            ));
+        count.births     += Index(std::popcount(unit & ~previous));
+        count.deaths     += Index(std::popcount(previous & ~unit));
+    };
+    for (auto index = begin; index + 1U < end; index++)
+        add(next[index], center[index]);
+    const auto lastUnit = next[end - 1U] & lastUnitMask;
+    add(lastUnit, center[end - 1U] & lastUnitMask);
+
+    // The bounds come from the first and the last alive units.
+    if (count.population != 0U) {
+        auto first = begin;
+        while (next[first] == 0U)
+            first++;
+        auto last = end - 1U;
+        auto unit = lastUnit;
+        while (unit == 0U)
+            unit = next[--last];
+        count.left  = first * bitNumber + Index(std::countr_zero(first == end - 1U ? lastUnit : next[first]));
+        count.right = (last + 1U) * bitNumber - Index(std::countl_zero(unit));
+    }
+    return count;
+}
@@ -0,0 +1,325 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <bit>
+#include <array>
+#include <vector>
+#include <unordered_map>
+#include <string>
+#include <string_view>
+#include <ostream>
+#include <charconv>
+#include <algorithm>
+#include "ShosLifeGameRule.h"
+
+namespace Shos::LifeGame {
+
+/// <summary>A pattern in the Macrocell format (.mc) of Golly: a quadtree in which each distinct subtree is written once.</summary>
+/// <remarks>
+/// After the "[M2]" line and "#R B3/S23" for the rule, each line is a node, numbered from 1: either a leaf of 8x8 cells,
+/// rows of '.' (dead) and '*' (alive) each ended by '$', or "level nw ne sw se", where a child of 0 is empty.
+/// The last node is the root, and the center of the root is the origin.
+/// The tree is kept as it is written, so a pattern of 10^8 cells takes the memory of its distinct subtrees only.
+/// </remarks>
+class Macrocell final
+{
+public:
+    using Coordinate = long long;
+    using Leaf       = std::uint64_t; // bit y * 8 + x is the cell (x, y) of a leaf
+
+    static constexpr unsigned int leafLevel    = 3U; // a leaf is 2^3 cells square
+    static constexpr unsigned int maximumLevel = 62U;
+
+    struct Node final
+    {
+        unsigned int level;
+        Leaf         leaf;        // the cells of a leaf
+        size_t       children[4]; // nw, ne, sw and se of a node above leafLevel
+    };
+
+    /// <summary>The bounds [left, right) x [top, bottom) of the alive cells.</summary>
+    struct Bounds final
+    {
+        Coordinate left;
+        Coordinate top;
+        Coordinate right;
+        Coordinate bottom;
+
+        bool IsEmpty() const
+        { return left >= right || top >= bottom; }
+    };
+
+private:
+    std::vector<Node> nodes; // nodes[0] is the empty node of any level
+    Rule              rule;
+
+public:
+    Macrocell() : nodes(1U, Node{})
+    {}
+
+    const Rule& GetRule() const
+    { return rule; }
+
+    bool IsEmpty() const
+    { return nodes.size() == 1U; }
+
+    unsigned int GetLevel() const
+    { return IsEmpty() ? leafLevel : nodes.back().level; }
+
+    /// <summary>Parses text; the nodes read before, if any, are dropped.</summary>
+    /// <returns>false if a line is not a two-state Macrocell line or refers to a node that is not before it, or if the rule is not supported.</returns>
+    bool Read(std::string_view text)
+    {
+        nodes.assign(1U, Node{});
+        rule = Rule();
+
+        std::string_view line;
+        while (ReadLine(text, line)) {
+            if (line.empty() || line.starts_with('['))
+                continue;
+            if (line.starts_with('#')) {
+                if (line.starts_with("#R") && !Rule::Parse(std::string(line.substr(2U)), rule))
+                    return false;
+                continue;
+            }
+
+            Node node{};
+            if (line[0] == '.' || line[0] == '*' || line[0] == '$') {
+                if (!ToLeaf(line, node.leaf))
+                    return false;
+                node.level = leafLevel;
+            } else if (!ToNode(line, node)) {
+                return false;
+            }
+            nodes.push_back(node);
+        }
+        return true;
+    }
+
+    /// <summary>Builds the tree bottom-up in one pass, each distinct subtree once.</summary>
+    /// <param name="makeLeaf">TNode(Leaf)</param>
+    /// <param name="join">TNode(TNode nw, TNode ne, TNode sw, TNode se)</param>
+    /// <param name="getEmpty">TNode(unsigned int level)</param>
+    /// <returns>The root.</returns>
+    template <typename TNode, typename TMakeLeaf, typename TJoin, typename TGetEmpty>
+    TNode Build(TMakeLeaf makeLeaf, TJoin join, TGetEmpty getEmpty) const
+    {
+        if (IsEmpty())
+            return getEmpty(leafLevel);
+
+        std::vector<TNode> built(nodes.size());
+        for (size_t index = 1U; index < nodes.size(); index++) {
+            const auto& node = nodes[index];
+            if (node.level == leafLevel) {
+                built[index] = makeLeaf(node.leaf);
+                continue;
+            }
+            TNode children[4];
+            for (auto quadrant = 0; quadrant < 4; quadrant++)
+                children[quadrant] = node.children[quadrant] == 0U ? getEmpty(node.level - 1U) : built[node.children[quadrant]];
+            built[index] = join(children[0], children[1], children[2], children[3]);
+        }
+        return built.back();
+    }
+
+    /// <summary>The bounds of the alive cells, found in one pass over the distinct subtrees.</summary>
+    Bounds GetBounds() const
+    {
+        constexpr Bounds empty = { 0, 0, 0, 0 };
+        if (IsEmpty())
+            return empty;
+
+        std::vector<Bounds> bounds(nodes.size(), empty); // relative to the left top of each node
+        for (size_t index = 1U; index < nodes.size(); index++) {
+            const auto& node = nodes[index];
+            if (node.level == leafLevel) {
+                bounds[index] = GetBounds(node.leaf);
+                continue;
+            }
+            const auto half = Coordinate(1) << (node.level - 1U);
+            auto&      all  = bounds[index];
+            for (auto quadrant = 0; quadrant < 4; quadrant++) {
+                const auto& part = bounds[node.children[quadrant]];
+                if (part.IsEmpty())
+                    continue;
+                const auto left = quadrant % 2 == 0 ? 0 : half;
+                const auto top  = quadrant / 2 == 0 ? 0 : half;
+                all = all.IsEmpty() ? Bounds{ left + part.left, top + part.top, left + part.right, top + part.bottom }
+                                    : Bounds{ std::min(all.left , left + part.left ), std::min(all.top   , top + part.top   ),
+                                              std::max(all.right, left + part.right), std::max(all.bottom, top + part.bottom) };
+            }
+        }
+
+        const auto half = GetHalf();
+        const auto root = bounds.back();
+        return root.IsEmpty() ? empty : Bounds{ root.left - half, root.top - half, root.right - half, root.bottom - half };
+    }
+
+    /// <summary>Calls action(left, top, leaf) for each leaf with an alive cell, with the left top cell of the leaf.</summary>
+    /// <remarks>Only the leaves that may have alive cells in bounds are visited; a shared subtree is visited at each of its places.</remarks>
+    template <typename TAction>
+    void ForEachLeaf(const Bounds& bounds, TAction action) const
+    {
+        if (!IsEmpty())
+            ForEachLeaf(nodes.size() - 1U, -GetHalf(), -GetHalf(), bounds, action);
+    }
+
+    /// <summary>Writes a quadtree in the Macrocell format, each distinct subtree once.</summary>
+    /// <remarks>The nodes are numbered as they are added, so the children of a node have to be added before it, and the root last.</remarks>
+    class Writer final
+    {
+        using Children = std::array<size_t, 4>;
+
+        struct ChildrenHash final
+        {
+            size_t operator()(const Children& children) const
+            {
+                std::uint64_t hash = 0U;
+                for (const auto child : children)
+                    hash = (hash ^ child) * 0x9e3779b97f4a7c15ULL;
+                return size_t(hash ^ (hash >> 29));
+            }
+        };
+
+        std::ostream&                                      stream;
+        std::unordered_map<Leaf, size_t>                   leaves;
+        std::unordered_map<Children, size_t, ChildrenHash> nodes;
+        size_t                                             nodeNumber;
+
+    public:
+        Writer(std::ostream& stream, const Rule& rule) : stream(stream), nodeNumber(0U)
+        { stream << "[M2] (Shos.LifeGame)\n#R " << rule.ToString() << '\n'; }
+
+        /// <returns>The number of the leaf, or 0 if it is empty.</returns>
+        size_t AddLeaf(Leaf leaf)
+        {
+            if (leaf == 0U)
+                return 0U;
+            const auto [iterator, isNew] = leaves.try_emplace(leaf, nodeNumber + 1U);
+            if (isNew) {
+                nodeNumber++;
+                WriteLeaf(leaf);
+            }
+            return iterator->second;
+        }
+
+        /// <param name="level">The level of the node, above leafLevel; the children are one level lower.</param>
+        /// <returns>The number of the node, or 0 if it is empty.</returns>
+        size_t AddNode(unsigned int level, size_t nw, size_t ne, size_t sw, size_t se)
+        {
+            if (nw == 0U && ne == 0U && sw == 0U && se == 0U)
+                return 0U;
+            const auto [iterator, isNew] = nodes.try_emplace(Children{ nw, ne, sw, se }, nodeNumber + 1U);
+            if (isNew) {
+                nodeNumber++;
+                stream << level << ' ' << nw << ' ' << ne << ' ' << sw << ' ' << se << '\n';
+            }
+            return iterator->second;
+        }
+
+        /// <summary>Writes an empty root of level if root, the node added last, is empty, as a file needs a root.</summary>
+        void End(unsigned int level, size_t root)
+        {
+            if (root == 0U)
+                stream << level << " 0 0 0 0\n";
+        }
+
+    private:
+        void WriteLeaf(Leaf leaf)
+        {
+            for (auto y = 0; y < 8; y++) {
+                const auto row = unsigned(leaf >> (y * 8)) & 0xffU;
+                for (auto x = 0U; x < std::bit_width(row); x++)
+                    stream << ((row >> x) & 1U ? '*' : '.');
+                stream << '$';
+            }
+            stream << '\n';
+        }
+    };
+
+private:
+    Coordinate GetHalf() const
+    { return Coordinate(1) << (GetLevel() - 1U); }
+
+    static bool ReadLine(std::string_view& text, std::string_view& line)
+    {
+        if (text.empty())
+            return false;
+        const auto end = std::min(text.find('\n'), text.length());
+        line           = text.substr(0U, end);
+        text.remove_prefix(std::min(end + 1U, text.length()));
+        while (!line.empty() && (line.back() == '\r' || line.back() == ' ' || line.back() == '\t'))
+            line.remove_suffix(1U);
+        return true;
+    }
+
+    static bool ToLeaf(std::string_view line, Leaf& leaf)
+    {
+        leaf = 0U;
+        unsigned int x = 0U, y = 0U;
+        for (const auto character : line) {
+            if (character == '$') {
+                x = 0U;
+                y++;
+                continue;
+            }
+            if ((character != '.' && character != '*') || x >= 8U || y >= 8U)
+                return false;
+            if (character == '*')
+                leaf |= Leaf(1) << (y * 8U + x);
+            x++;
+        }
+        return true;
+    }
+
+    bool ToNode(std::string_view line, Node& node) const
+    {
+        const auto end    = line.data() + line.length();
+        auto       cursor = line.data();
+        const auto read   = [&](auto& value) {
+            while (cursor != end && *cursor == ' ')
+                cursor++;
+            const auto [next, error] = std::from_chars(cursor, end, value);
+            cursor = next;
+            return error == std::errc();
+        };
+
+        if (!read(node.level) || node.level <= leafLevel || maximumLevel < node.level)
+            return false;
+        for (auto& child : node.children) {
+            if (!read(child) || nodes.size() <= child || (child != 0U && nodes[child].level + 1U != node.level))
+                return false;
+        }
+        return true;
+    }
+
+    static Bounds GetBounds(Leaf leaf)
+    {
+        unsigned int columns = 0U;
+        for (auto y = 0; y < 8; y++)
+            columns |= unsigned(leaf >> (y * 8)) & 0xffU;
+        return Bounds{ std::countr_zero(columns), std::countr_zero(leaf) / 8, std::bit_width(columns), 8 - std::countl_zero(leaf) / 8 };
+    }
+
+    template <typename TAction>
+    void ForEachLeaf(size_t index, Coordinate left, Coordinate top, const Bounds& bounds, TAction& action) const
+    {
+        const auto& node = nodes[index];
+        const auto  size = Coordinate(1) << node.level;
+        if (index == 0U || left >= bounds.right || top >= bounds.bottom || left + size <= bounds.left || top + size <= bounds.top)
+            return;
+
+        if (node.level == leafLevel) {
+            action(left, top, node.leaf);
+            return;
+        }
+        const auto half = size / 2;
+        ForEachLeaf(node.children[0], left       , top       , bounds, action);
+        ForEachLeaf(node.children[1], left + half, top       , bounds, action);
+        ForEachLeaf(node.children[2], left       , top + half, bounds, action);
+        ForEachLeaf(node.children[3], left + half, top + half, bounds, action);
+    }
+};
+
+} // namespace Shos::LifeGame
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <chrono>
+#include <vector>
+#include <ostream>
+#include <iomanip>
+#include <algorithm>
+#include <limits>
+
+namespace Shos::LifeGame {
+
+/// <summary>Steady-clock timings, in nanoseconds, of the phases of a generation and of the work of each worker.</summary>
+/// <remarks>
+/// A round is one run of the workers: a generation of Game::Next, the depth generations of Game::NextBlocked,
+/// or all the generations of Game::Advance when the workers are started once for them.
+/// The slowest worker of a round sets its time, so the load imbalance is the sum of the slowest worker times over the sum of the mean worker times
+/// (1 when the work is even), and the dispatch time is the time of Compute that the slowest worker did not spend working:
+/// the time to wake the workers, to join them and, in Game::Advance, to wait for the bands next to them.
+/// </remarks>
+class Profiler final
+{
+public:
+    using Clock       = std::chrono::steady_clock;
+    using TimePoint   = Clock::time_point;
+    using Nanoseconds = unsigned long long;
+
+    enum class Phase
+    {
+        Ghosts , // Board::UpdateGhosts
+        Reset  , // resetting the areas of the workers
+        Compute, // computing the next generations, with all the workers
+        Union  , // joining the areas or the tiles of the workers
+        Swap   , // swapping the boards
+        Bits   , // Board::GetBits, packing the cells to paint
+        Paint  , // painting the bits
+        Number
+    };
+
+    struct Sample final
+    {
+        unsigned long long count;
+        Nanoseconds        total;
+        Nanoseconds        minimum;
+        Nanoseconds        maximum;
+
+        Sample() : count(0ULL), total(0ULL), minimum(std::numeric_limits<Nanoseconds>::max()), maximum(0ULL)
+        {}
+
+        void Add(Nanoseconds time)
+        {
+            count++;
+            total  += time;
+            minimum = std::min(minimum, time);
+            maximum = std::max(maximum, time);
+        }
+
+        double GetMean() const
+        { return count == 0ULL ? 0.0 : double(total) / double(count); }
+    };
+
+    /// <remarks>Aligned to a cache line, as each worker writes its own.</remarks>
+    struct alignas(64) Worker final
+    {
+        Nanoseconds total; // the time the worker worked
+        Nanoseconds round; // of the current round
+    };
+
+    /// <summary>Times a phase from its construction to its destruction.</summary>
+    class Scope final
+    {
+        Profiler& profiler;
+        Phase     phase;
+        TimePoint begin;
+
+    public:
+        Scope(Profiler& profiler, Phase phase) : profiler(profiler), phase(phase), begin(Now())
+        {}
+
+        ~Scope()
+        { profiler.Add(phase, GetNanoseconds(begin, Now())); }
+
+        Scope(const Scope&)            = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    /// <summary>Times the work of a worker in the current round from its construction to its destruction.</summary>
+    class WorkScope final
+    {
+        Profiler&    profiler;
+        unsigned int index;
+        TimePoint    begin;
+
+    public:
+        WorkScope(Profiler& profiler, unsigned int index) : profiler(profiler), index(index), begin(Now())
+        {}
+
+        ~WorkScope()
+        { profiler.AddWork(index, GetNanoseconds(begin, Now())); }
+
+        WorkScope(const WorkScope&)            = delete;
+        WorkScope& operator=(const WorkScope&) = delete;
+    };
+
+    /// <summary>Times a round, which has to join its workers before the destruction, and ends it.</summary>
+    class RoundScope final
+    {
+        Profiler& profiler;
+        TimePoint begin;
+
+    public:
+        explicit RoundScope(Profiler& profiler) : profiler(profiler), begin(Now())
+        {}
+
+        ~RoundScope()
+        { profiler.EndRound(GetNanoseconds(begin, Now())); }
+
+        RoundScope(const RoundScope&)            = delete;
+        RoundScope& operator=(const RoundScope&) = delete;
+    };
+
+private:
+    Sample              samples[size_t(Phase::Number)];
+    std::vector<Worker> workers;
+    unsigned long long  roundNumber;
+    Nanoseconds         slowestTotal ; // the sum of the slowest worker time of each round
+    Nanoseconds         dispatchTotal;
+
+public:
+    explicit Profiler(unsigned int workerNumber = 1U) : workers(std::max(workerNumber, 1U)), roundNumber(0ULL), slowestTotal(0ULL), dispatchTotal(0ULL)
+    { Clear(); }
+
+    static TimePoint Now()
+    { return Clock::now(); }
+
+    static Nanoseconds GetNanoseconds(TimePoint begin, TimePoint end)
+    { return Nanoseconds(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count()); }
+
+    static const char* GetName(Phase phase)
+    {
+        static const char* const names[] = { "Ghosts", "Reset", "Compute", "Union", "Swap", "Bits", "Paint" };
+        return names[size_t(phase)];
+    }
+
+    void Clear()
+    {
+        std::fill(std::begin(samples), std::end(samples), Sample());
+        std::fill(workers.begin(), workers.end(), Worker{ 0ULL, 0ULL });
+        roundNumber   = 0ULL;
+        slowestTotal  = 0ULL;
+        dispatchTotal = 0ULL;
+    }
+
+    void Add(Phase phase, Nanoseconds time)
+    { samples[size_t(phase)].Add(time); }
+
+    /// <summary>Adds the time worker index has worked in the current round; only that worker may call this during the round.</summary>
+    void AddWork(unsigned int index, Nanoseconds time)
+    {
+        auto& worker = workers[index];
+        worker.total += time;
+        worker.round += time;
+    }
+
+    /// <summary>Ends a round after the workers have been joined, and adds computeTime, the time of the whole round, to Compute.</summary>
+    void EndRound(Nanoseconds computeTime)
+    {
+        auto slowest = 0ULL;
+        for (auto& worker : workers) {
+            slowest      = std::max(slowest, worker.round);
+            worker.round = 0ULL;
+        }
+        Add(Phase::Compute, computeTime);
+        roundNumber++;
+        slowestTotal  += slowest;
+        dispatchTotal += computeTime > slowest ? computeTime - slowest : 0ULL;
+    }
+
+    const Sample& Get(Phase phase) const
+    { return samples[size_t(phase)]; }
+
+    unsigned int GetWorkerNumber() const
+    { return unsigned(workers.size()); }
+
+    const Worker& GetWorker(unsigned int index) const
+    { return workers[index]; }
+
+    unsigned long long GetRoundNumber() const
+    { return roundNumber; }
+
+    /// <returns>The sum of the slowest worker times over the sum of the mean worker times; 1 if the work is even.</returns>
+    double GetImbalance() const
+    {
+        auto total = 0ULL;
+        for (const auto& worker : workers)
+            total += worker.total;
+        return total == 0ULL ? 1.0 : double(slowestTotal) * double(workers.size()) / double(total);
+    }
+
+    /// <returns>The time of Compute not spent working by the slowest worker of each round.</returns>
+    Nanoseconds GetDispatchTime() const
+    { return dispatchTotal; }
+
+    /// <summary>Writes a table of the phases and the workers, in microseconds.</summary>
+    void Write(std::ostream& stream) const
+    {
+        const auto flags          = stream.flags();
+        const auto precision      = stream.precision();
+        const auto toMicroseconds = [](double nanoseconds) { return nanoseconds / 1000.0; };
+
+        stream << std::fixed << std::setprecision(1)
+               << std::left  << std::setw(10) << "Phase" << std::right
+               << std::setw(10) << "Count" << std::setw(14) << "Total(us)" << std::setw(12) << "Mean(us)"
+               << std::setw(12) << "Min(us)" << std::setw(12) << "Max(us)" << '\n';
+        for (auto index = size_t(0); index < size_t(Phase::Number); index++) {
+            const auto& sample = samples[index];
+            if (sample.count == 0ULL)
+                continue;
+            stream << std::left  << std::setw(10) << GetName(Phase(index)) << std::right
+                   << std::setw(10) << sample.count
+                   << std::setw(14) << toMicroseconds(double(sample.total  ))
+                   << std::setw(12) << toMicroseconds(sample.GetMean()      )
+                   << std::setw(12) << toMicroseconds(double(sample.minimum))
+                   << std::setw(12) << toMicroseconds(double(sample.maximum)) << '\n';
+        }
+
+        if (roundNumber != 0ULL) {
+            stream << "Rounds " << roundNumber << ", dispatch(us) " << toMicroseconds(double(dispatchTotal))
+                   << ", imbalance " << std::setprecision(3) << GetImbalance() << std::setprecision(1) << '\n';
+            for (auto index = 0U; index < GetWorkerNumber(); index++)
+                stream << "Worker " << std::setw(3) << index << std::setw(14) << toMicroseconds(double(workers[index].total)) << '\n';
+        }
+
+        stream.flags(flags);
+        stream.precision(precision);
+    }
+};
+
+} // namespace Shos::LifeGame
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstdint>
+#include <cctype>
+#include <string>
+
+namespace Shos::LifeGame {
+
+/// <summary>An outer-totalistic Life-like rule, in B/S notation: the numbers of alive neighbors that bring a dead cell to life, and those that keep an alive cell alive.</summary>
+/// <remarks>Bit n of each mask stands for n alive neighbors. Rules with B0 are not supported, as they would bring the space around the board to life.</remarks>
+class Rule final
+{
+    std::uint16_t birth;
+    std::uint16_t survival;
+
+public:
+    /// <summary>B3/S23, Conway's Game of Life.</summary>
+    constexpr Rule() : Rule(Mask("3"), Mask("23"))
+    {}
+
+    constexpr Rule(std::uint16_t birth, std::uint16_t survival) : birth(birth), survival(survival)
+    {}
+
+    static constexpr Rule Conway()
+    { return Rule(); }
+
+    static constexpr Rule HighLife()
+    { return Rule(Mask("36"), Mask("23")); }
+
+    static constexpr Rule DayAndNight()
+    { return Rule(Mask("3678"), Mask("34678")); }
+
+    static constexpr Rule Seeds()
+    { return Rule(Mask("2"), Mask("")); }
+
+    constexpr std::uint16_t GetBirth() const
+    { return birth; }
+
+    constexpr std::uint16_t GetSurvival() const
+    { return survival; }
+
+    /// <summary>Whether birth and survival count 0 to 8 alive neighbors only, and birth does not count 0 (B0).</summary>
+    static constexpr bool IsSupported(std::uint16_t birth, std::uint16_t survival)
+    { return (birth & 1U) == 0U && (birth >> 9) == 0U && (survival >> 9) == 0U; }
+
+    constexpr bool IsAlive(bool alive, unsigned int aliveNeighborCount) const
+    { return (((alive ? survival : birth) >> aliveNeighborCount) & 1U) != 0U; }
+
+    constexpr bool operator==(const Rule& rule) const
+    { return birth == rule.birth && survival == rule.survival; }
+
+    std::string ToString() const
+    { return std::string("B").append(ToString(birth)).append("/S").append(ToString(survival)); } // not "B" + ..., on which GCC 12 gives a false -Wrestrict warning
+
+    /// <summary>Parses "B36/S23" (in any case) or the older "23/36" (survival/birth) notation.</summary>
+    /// <remarks>A Golly bounded-grid suffix such as ":T100,100" is ignored.</remarks>
+    static bool Parse(std::string text, Rule& rule)
+    {
+        text = text.substr(0U, text.find(':'));
+        std::erase_if(text, [](char character) { return std::isspace(static_cast<unsigned char>(character)); });
+
+        const auto slash = text.find('/');
+        if (slash == std::string::npos)
+            return false;
+
+        const auto first  = text.substr(0U, slash);
+        const auto second = text.substr(slash + 1U);
+        std::string birthText, survivalText;
+        if (StartsWith(first, 'b') && StartsWith(second, 's')) {
+            birthText    = first .substr(1U);
+            survivalText = second.substr(1U);
+        } else if (StartsWith(first, 's') && StartsWith(second, 'b')) {
+            birthText    = second.substr(1U);
+            survivalText = first .substr(1U);
+        } else {
+            birthText    = second;
+            survivalText = first ;
+        }
+
+        std::uint16_t birthMask, survivalMask;
+        if (!ToMask(birthText, birthMask) || !ToMask(survivalText, survivalMask) || !IsSupported(birthMask, survivalMask))
+            return false;
+        rule = Rule(birthMask, survivalMask);
+        return true;
+    }
+
+private:
+    static constexpr std::uint16_t Mask(const char* counts)
+    {
+        std::uint16_t mask = 0U;
+        for (; *counts != '\0'; counts++)
+            mask |= std::uint16_t(1U << (*counts - '0'));
+        return mask;
+    }
+
+    static bool StartsWith(const std::string& text, char letter)
+    { return !text.empty() && std::tolower(static_cast<unsigned char>(text[0])) == letter; }
+
+    static bool ToMask(const std::string& counts, std::uint16_t& mask)
+    {
+        mask = 0U;
+        for (const auto character : counts) {
+            if (character < '0' || '8' < character)
+                return false;
+            mask |= std::uint16_t(1U << (character - '0'));
+        }
+        return true;
+    }
+
+    static std::string ToString(std::uint16_t mask)
+    {
+        std::string counts;
+        for (auto count = 0; count <= 8; count++) {
+            if ((mask >> count) & 1U)
+                counts += char('0' + count);
+        }
+        return counts;
+    }
+};
+
+} // namespace Shos::LifeGame
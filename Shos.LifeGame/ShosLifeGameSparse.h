@@ -0,0 +1,323 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <bit>
+#include <array>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <limits>
+#include "ShosLifeGameKernel.h"
+
+namespace Shos::LifeGame {
+
+/// <summary>An unbounded universe made of chunks of 64x64 cells, kept in a hash map.</summary>
+/// <remarks>
+/// Chunks are allocated when a cell in them becomes alive and freed when they become empty,
+/// so memory is proportional to the live content and not to the extent of the universe.
+/// Each chunk keeps the indexes of its neighbors, which are linked when a chunk is born and unlinked when it dies,
+/// so a generation looks a chunk up only to link it.
+/// The rule is the one of the universe, computed by the kernel Kernel picked for it.
+/// </remarks>
+class SparseUniverse final
+{
+public:
+    using Coordinate = long long;
+
+private:
+    using Unit  = KernelImplementation::Unit ;
+    using Index = KernelImplementation::Index;
+    using Key   = std::uint64_t;
+    using Links = std::array<Index, 9>; // the indexes of the chunks at (dx, dy) for dx and dy in -1 to 1, the center being the chunk itself
+
+    static constexpr Index none = std::numeric_limits<Index>::max();
+
+    static constexpr Coordinate chunkSize = Coordinate(sizeof(Unit) * 8);
+    static constexpr Coordinate chunkBit  = 6;
+
+    struct Chunk final
+    {
+        Unit rows[chunkSize];
+
+        bool IsEmpty() const
+        { return std::all_of(std::begin(rows), std::end(rows), [](Unit row) { return row == 0U; }); }
+    };
+
+    struct KeyHash final
+    {
+        size_t operator()(Key key) const
+        {
+            key ^= key >> 33;
+            key *= 0xff51afd7ed558ccdULL;
+            key ^= key >> 33;
+            return size_t(key);
+        }
+    };
+
+    std::vector<Chunk>                          chunks;
+    std::vector<Key>                            keys;
+    std::vector<Links>                          links;
+    std::unordered_map<Key, Index, KeyHash>     indexes;
+    std::vector<Chunk>                          nextChunks;
+    RuleKernel                                  kernel;
+
+public:
+    Rule GetRule() const
+    { return kernel.GetRule(); }
+
+    void SetRule(const Rule& rule)
+    { kernel = RuleKernel(rule); }
+
+    size_t GetChunkNumber() const
+    { return chunks.size(); }
+
+    unsigned long long GetPopulation() const
+    {
+        unsigned long long population = 0ULL;
+        for (const auto& chunk : chunks) {
+            for (const auto row : chunk.rows)
+                population += std::popcount(row);
+        }
+        return population;
+    }
+
+    void Clear()
+    {
+        chunks .clear();
+        keys   .clear();
+        links  .clear();
+        indexes.clear();
+    }
+
+    bool Get(Coordinate x, Coordinate y) const
+    {
+        const auto chunk = Find(ToKey(x >> chunkBit, y >> chunkBit));
+        return chunk != nullptr && (chunk->rows[y & (chunkSize - 1)] >> (x & (chunkSize - 1)) & 1U) != 0U;
+    }
+
+    void Set(Coordinate x, Coordinate y, bool value)
+    {
+        const auto key      = ToKey(x >> chunkBit, y >> chunkBit);
+        const auto iterator = indexes.find(key);
+        const auto bit      = Unit(1) << (x & (chunkSize - 1));
+
+        if (iterator == indexes.end()) {
+            if (value)
+                chunks[Insert(key)].rows[y & (chunkSize - 1)] = bit;
+            return;
+        }
+
+        auto& row = chunks[iterator->second].rows[y & (chunkSize - 1)];
+        row       = value ? row | bit : row & ~bit;
+        if (!value && chunks[iterator->second].IsEmpty())
+            Erase(iterator->second);
+    }
+
+    /// <summary>Places the pattern so that its center is at the origin.</summary>
+    template <typename TPattern>
+    void Set(const TPattern& pattern)
+    {
+        const auto size = pattern.GetSize();
+        Set(size.cx, size.cy, [&](auto y) { return pattern.GetRow(y); });
+    }
+
+    /// <summary>Places width x height cells so that their center is at the origin.</summary>
+    /// <param name="getRow">getRow(y) returns the row y as units of 64 cells, bit n of a unit being its n-th cell from the left.</param>
+    /// <remarks>Each chunk is filled a unit at a time, and only the chunks with alive cells are kept.</remarks>
+    template <typename TGetRow>
+    void Set(Coordinate width, Coordinate height, TGetRow getRow)
+    {
+        Clear();
+
+        const auto left = -(width  / 2);
+        const auto top  = -(height / 2);
+        for (auto chunkY = top >> chunkBit; chunkY <= (top + height - 1) >> chunkBit; chunkY++) {
+            for (auto chunkX = left >> chunkBit; chunkX <= (left + width - 1) >> chunkBit; chunkX++) {
+                Chunk chunk;
+                for (Coordinate y = 0; y < chunkSize; y++) {
+                    const auto patternY = (chunkY << chunkBit) + y - top;
+                    chunk.rows[y]       = 0 <= patternY && patternY < height ? GetUnit(getRow(patternY), width, (chunkX << chunkBit) - left) : Unit(0);
+                }
+                if (!chunk.IsEmpty())
+                    chunks[Insert(ToKey(chunkX, chunkY))] = chunk;
+            }
+        }
+    }
+
+    void Next()
+    { Next([](Index count, auto action) { action(0U, count); }); }
+
+    /// <param name="forEach">forEach(count, action) calls action(begin, end) on ranges covering [0, count), possibly in parallel.</param>
+    /// <remarks>The empty chunks next to a live cell are born first, and the chunks that end up empty die after.</remarks>
+    template <typename TForEach>
+    void Next(TForEach forEach)
+    {
+        InsertCandidates();
+        nextChunks.resize(chunks.size());
+
+        forEach(Index(chunks.size()), [this](Index begin, Index end) {
+            for (auto index = begin; index < end; index++)
+                Next(links[index], nextChunks[index]);
+        });
+
+        chunks.swap(nextChunks);
+        // From the back, so that Erase moves only chunks already kept into the place of the dead one.
+        for (auto index = Index(chunks.size()); index-- > 0U; ) {
+            if (chunks[index].IsEmpty())
+                Erase(index);
+        }
+    }
+
+    /// <summary>Calls setCell(x, y) for each live cell in [left, left + width) x [top, top + height).</summary>
+    template <typename TSetCell>
+    void ForEachAlive(Coordinate left, Coordinate top, Coordinate width, Coordinate height, TSetCell setCell) const
+    {
+        for (Index index = 0U; index < chunks.size(); index++) {
+            const auto chunkLeft = Coordinate(std::int32_t(keys[index]      )) << chunkBit;
+            const auto chunkTop  = Coordinate(std::int32_t(keys[index] >> 32)) << chunkBit;
+            if (chunkLeft >= left + width || chunkTop >= top + height || chunkLeft + chunkSize <= left || chunkTop + chunkSize <= top)
+                continue;
+
+            for (Coordinate y = 0; y < chunkSize; y++) {
+                if (chunkTop + y < top || top + height <= chunkTop + y)
+                    continue;
+                for (auto row = chunks[index].rows[y]; row != 0U; row &= row - 1U) {
+                    const auto x = chunkLeft + std::countr_zero(row);
+                    if (left <= x && x < left + width)
+                        setCell(x, chunkTop + y);
+                }
+            }
+        }
+    }
+
+private:
+    /// <summary>The 64 cells of a row of width cells from x on; x may be off the row.</summary>
+    static Unit GetUnit(const Unit* row, Coordinate width, Coordinate x)
+    {
+        if (x >= width || x + chunkSize <= 0)
+            return 0U;
+
+        const auto index = x >> chunkBit;
+        const auto shift = x & (chunkSize - 1);
+        const auto low   = index >= 0 ? row[index] : Unit(0);
+        const auto high  = shift != 0 && (index + 1) * chunkSize < width ? row[index + 1] : Unit(0);
+        auto       unit  = shift == 0 ? low : low >> shift | high << (chunkSize - shift);
+        if (width - x < chunkSize)
+            unit &= (Unit(1) << (width - x)) - 1U;
+        return unit;
+    }
+
+    static Key ToKey(Coordinate chunkX, Coordinate chunkY)
+    { return (Key(std::uint32_t(chunkY)) << 32) | std::uint32_t(chunkX); }
+
+    static Key Offset(Key key, int dx, int dy)
+    { return ToKey(std::int32_t(key) + dx, std::int32_t(key >> 32) + dy); }
+
+    const Chunk* Find(Key key) const
+    {
+        const auto iterator = indexes.find(key);
+        return iterator == indexes.end() ? nullptr : &chunks[iterator->second];
+    }
+
+    /// <summary>Adds an empty chunk at key and links it with its neighbors.</summary>
+    /// <returns>The index of the chunk.</returns>
+    Index Insert(Key key)
+    {
+        const auto index = Index(chunks.size());
+        indexes.emplace(key, index);
+        keys  .push_back(key);
+        chunks.push_back(Chunk());
+        links .push_back(Links());
+
+        for (Index link = 0U; link < 9U; link++) {
+            if (link == 4U) {
+                links[index][link] = index;
+                continue;
+            }
+            const auto iterator = indexes.find(Offset(key, int(link % 3U) - 1, int(link / 3U) - 1));
+            links[index][link]  = iterator == indexes.end() ? none : iterator->second;
+            if (iterator != indexes.end())
+                links[iterator->second][8U - link] = index;
+        }
+        return index;
+    }
+
+    /// <summary>Removes the chunk at index, unlinking it, and moves the last chunk into its place.</summary>
+    void Erase(Index index)
+    {
+        indexes.erase(keys[index]);
+        for (Index link = 0U; link < 9U; link++) {
+            if (link != 4U && links[index][link] != none)
+                links[links[index][link]][8U - link] = none;
+        }
+
+        const auto last = Index(chunks.size() - 1U);
+        if (index < last) {
+            chunks[index]        = chunks[last];
+            keys  [index]        = keys  [last];
+            links [index]        = links [last];
+            links [index][4]     = index;
+            indexes[keys[index]] = index;
+            for (Index link = 0U; link < 9U; link++) {
+                if (link != 4U && links[index][link] != none)
+                    links[links[index][link]][8U - link] = index;
+            }
+        }
+        chunks.pop_back();
+        keys  .pop_back();
+        links .pop_back();
+    }
+
+    /// <summary>Adds the empty chunks next to a live cell on the edges of the live chunks.</summary>
+    void InsertCandidates()
+    {
+        const auto chunkNumber = Index(chunks.size());
+        for (Index index = 0U; index < chunkNumber; index++) {
+            const auto& rows    = chunks[index].rows;
+            Unit        columns = 0U;
+            for (const auto row : rows)
+                columns |= row;
+
+            const auto west  = (columns & 1U) != 0U;
+            const auto east  = (columns >> (chunkSize - 1)) != 0U;
+            const auto north = rows[0] != 0U;
+            const auto south = rows[chunkSize - 1] != 0U;
+            const bool sides[3][3] = {
+                { (rows[0] & 1U) != 0U            , north, (rows[0] >> (chunkSize - 1)) != 0U             },
+                { west                            , false, east                                           },
+                { (rows[chunkSize - 1] & 1U) != 0U, south, (rows[chunkSize - 1] >> (chunkSize - 1)) != 0U }
+            };
+            for (auto dy = -1; dy <= 1; dy++) {
+                for (auto dx = -1; dx <= 1; dx++) {
+                    if (sides[dy + 1][dx + 1] && links[index][(dy + 1) * 3 + dx + 1] == none)
+                        Insert(Offset(keys[index], dx, dy));
+                }
+            }
+        }
+    }
+
+    /// <summary>Computes the next generation of a chunk from it and its eight neighbors, at the indexes of links.</summary>
+    void Next(const Links& links, Chunk& next) const
+    {
+        // Rows -1 to 64 of the west, center and east chunks, so that the kernel reads every neighbor in place.
+        constexpr Index stride = 3U;
+        Unit            buffer[(chunkSize + 2) * stride];
+
+        const Chunk*    neighbors[3][3];
+        for (Index link = 0U; link < 9U; link++)
+            neighbors[link / 3U][link % 3U] = links[link] == none ? nullptr : &chunks[links[link]];
+
+        for (Coordinate y = -1; y <= chunkSize; y++) {
+            const auto& row = neighbors[y < 0 ? 0 : (y < chunkSize ? 1 : 2)];
+            for (Index x = 0U; x < stride; x++)
+                buffer[(y + 1) * stride + x] = row[x] == nullptr ? 0U : row[x]->rows[y & (chunkSize - 1)];
+        }
+
+        // A row of one unit, with the rule of the kernel.
+        for (Coordinate y = 0; y < chunkSize; y++)
+            kernel.NextRow(&buffer[(y + 1) * stride + 1], stride, &next.rows[y], 0U, 1U);
+    }
+};
+
+} // namespace Shos::LifeGame
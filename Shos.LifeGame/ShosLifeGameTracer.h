@@ -0,0 +1,278 @@
+#pragma once
+
+#include <chrono>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <ostream>
+#include <algorithm>
+#include <iomanip>
+
+namespace Shos::LifeGame {
+
+/// <summary>Spans of time on each thread, written as Chrome trace events in JSON, which chrome://tracing and Perfetto open.</summary>
+/// <remarks>
+/// Each thread that records a span gets its own ring buffer once, so recording takes no lock and no atomic read-modify-write:
+/// the thread stores the event and then its count. A buffer keeps the last eventNumber spans of its thread.
+/// When the thread exits, its spans are copied out and its buffer is kept for the next thread, so there are only as many buffers
+/// as threads that trace at the same time.
+/// Nothing is recorded until Start. Write and Clear read the buffers of the other threads, so they need those threads to be idle,
+/// as they are between the calls of Game.
+/// </remarks>
+class Tracer final
+{
+public:
+    using Clock       = std::chrono::steady_clock;
+    using Nanoseconds = unsigned long long;
+    using Argument    = long long;
+
+    static constexpr size_t eventNumber = size_t(1) << 16; // a power of 2
+
+    struct Event final
+    {
+        const char* name;
+        const char* argumentName; // nullptr if the span has no argument
+        Argument    argument;
+        Nanoseconds begin;        // since the tracer was loaded
+        Nanoseconds duration;
+    };
+
+    /// <summary>Records a span from its construction to its destruction, if the tracer has been started.</summary>
+    /// <remarks>name and argumentName have to outlive the tracer, as string literals do.</remarks>
+    class Span final
+    {
+        const char* name;
+        const char* argumentName;
+        Argument    argument;
+        Nanoseconds begin;
+        bool        isEnabled;
+
+    public:
+        explicit Span(const char* name, const char* argumentName = nullptr, Argument argument = 0LL)
+            : name(name), argumentName(argumentName), argument(argument), begin(0ULL), isEnabled(IsEnabled())
+        {
+            if (isEnabled)
+                begin = Now();
+        }
+
+        ~Span()
+        {
+            if (isEnabled)
+                Add(Event{ name, argumentName, argument, begin, Now() - begin });
+        }
+
+        Span(const Span&)            = delete;
+        Span& operator=(const Span&) = delete;
+    };
+
+private:
+    class Buffer final
+    {
+        std::unique_ptr<Event[]>        events;
+        std::atomic<unsigned long long> count; // of the events ever added
+
+    public:
+        unsigned int id;
+        std::string  name;
+
+        Buffer() : events(new Event[eventNumber]), count(0ULL), id(0U)
+        {}
+
+        /// <summary>Gives the buffer to another thread.</summary>
+        void Reset(unsigned int id, const std::string& name)
+        {
+            Clear();
+            this->id   = id;
+            this->name = name.empty() ? "Thread " + std::to_string(id) : name;
+        }
+
+        /// <remarks>Only the thread of the buffer adds events.</remarks>
+        void Add(const Event& event)
+        {
+            const auto index = count.load(std::memory_order_relaxed);
+            events[size_t(index) & (eventNumber - 1U)] = event;
+            count.store(index + 1ULL, std::memory_order_release);
+        }
+
+        template <typename TAction>
+        void ForEach(TAction action) const
+        {
+            const auto last = count.load(std::memory_order_acquire);
+            for (auto index = last > eventNumber ? last - eventNumber : 0ULL; index < last; index++)
+                action(events[size_t(index) & (eventNumber - 1U)]);
+        }
+
+        void Clear()
+        { count.store(0ULL, std::memory_order_relaxed); }
+    };
+
+    /// <summary>The spans of a thread that has exited.</summary>
+    struct Thread final
+    {
+        unsigned int       id;
+        std::string        name;
+        std::vector<Event> events;
+    };
+
+    /// <summary>Holds the buffer of its thread, and releases it when the thread exits.</summary>
+    struct Owner final
+    {
+        Buffer* buffer = nullptr;
+
+        ~Owner()
+        {
+            if (buffer != nullptr)
+                Release(buffer);
+        }
+    };
+
+    inline static const Clock::time_point              origin = Clock::now();
+    inline static std::atomic<bool>                    enabled { false };
+    inline static std::mutex                           buffersMutex;
+    inline static std::vector<std::unique_ptr<Buffer>> buffers;       // of the threads alive
+    inline static std::vector<std::unique_ptr<Buffer>> freeBuffers;   // released, to be given to the next threads
+    inline static std::vector<Thread>                  exitedThreads;
+    inline static unsigned int                         threadNumber = 0U;
+
+public:
+    static void Start()
+    { enabled.store(true, std::memory_order_relaxed); }
+
+    static void Stop()
+    { enabled.store(false, std::memory_order_relaxed); }
+
+    static bool IsEnabled()
+    { return enabled.load(std::memory_order_relaxed); }
+
+    /// <summary>Names the calling thread "name index" in the trace, as a worker of a ThreadPool; it has to be called before the first span of the thread.</summary>
+    static void SetThreadName(const char* name, unsigned int index)
+    { GetThreadName() = std::string(name) + ' ' + std::to_string(index); }
+
+    /// <summary>Drops the spans recorded so far, and frees the buffers no thread holds.</summary>
+    static void Clear()
+    {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        for (const auto& buffer : buffers)
+            buffer->Clear();
+        freeBuffers  .clear();
+        exitedThreads.clear();
+    }
+
+    /// <summary>Writes the spans of all the threads as a JSON object of trace events, in microseconds.</summary>
+    static void Write(std::ostream& stream)
+    {
+        const auto flags          = stream.flags();
+        const auto precision      = stream.precision();
+        const auto toMicroseconds = [](Nanoseconds nanoseconds) { return double(nanoseconds) / 1000.0; };
+        auto       isFirst        = true;
+        const auto separate       = [&]() {
+            stream << (isFirst ? "\n" : ",\n");
+            isFirst = false;
+        };
+
+        const auto writeThread    = [&](unsigned int id, const std::string& name, const auto& forEach) {
+            separate();
+            stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << id << ",\"args\":{\"name\":";
+            WriteString(stream, name);
+            stream << "}}";
+            forEach([&](const Event& event) {
+                separate();
+                stream << "{\"name\":";
+                WriteString(stream, event.name);
+                stream << ",\"cat\":\"LifeGame\",\"ph\":\"X\",\"ts\":" << toMicroseconds(event.begin)
+                       << ",\"dur\":" << toMicroseconds(event.duration) << ",\"pid\":1,\"tid\":" << id;
+                if (event.argumentName != nullptr) {
+                    stream << ",\"args\":{";
+                    WriteString(stream, event.argumentName);
+                    stream << ':' << event.argument << '}';
+                }
+                stream << '}';
+            });
+        };
+
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        stream << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[" << std::fixed << std::setprecision(3);
+        for (const auto& thread : exitedThreads)
+            writeThread(thread.id, thread.name, [&](const auto& action) { std::for_each(thread.events.begin(), thread.events.end(), action); });
+        for (const auto& buffer : buffers)
+            writeThread(buffer->id, buffer->name, [&](const auto& action) { buffer->ForEach(action); });
+        stream << "\n]}\n";
+
+        stream.flags(flags);
+        stream.precision(precision);
+    }
+
+private:
+    static Nanoseconds Now()
+    { return Nanoseconds(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - origin).count()); }
+
+    static void Add(const Event& event)
+    { GetBuffer().Add(event); }
+
+    static std::string& GetThreadName()
+    {
+        thread_local std::string name;
+        return name;
+    }
+
+    /// <summary>The buffer of the calling thread, given to it on its first span.</summary>
+    static Buffer& GetBuffer()
+    {
+        thread_local Owner owner;
+        if (owner.buffer == nullptr) {
+            std::lock_guard<std::mutex> lock(buffersMutex);
+            if (freeBuffers.empty()) {
+                buffers.push_back(std::make_unique<Buffer>());
+            } else {
+                buffers.push_back(std::move(freeBuffers.back()));
+                freeBuffers.pop_back();
+            }
+            owner.buffer = buffers.back().get();
+            owner.buffer->Reset(threadNumber++, GetThreadName());
+        }
+        return *owner.buffer;
+    }
+
+    /// <summary>Copies the spans of an exiting thread out of its buffer, and keeps the buffer for the next thread.</summary>
+    static void Release(Buffer* buffer)
+    {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        Thread thread{ buffer->id, buffer->name, {} };
+        buffer->ForEach([&](const Event& event) { thread.events.push_back(event); });
+        if (!thread.events.empty())
+            exitedThreads.push_back(std::move(thread));
+
+        const auto iterator = std::find_if(buffers.begin(), buffers.end(), [=](const std::unique_ptr<Buffer>& item) { return item.get() == buffer; });
+        freeBuffers.push_back(std::move(*iterator));
+        buffers.erase(iterator);
+    }
+
+    /// <summary>Writes text as a JSON string.</summary>
+    static void WriteString(std::ostream& stream, std::string_view text)
+    {
+        const auto flags = stream.flags();
+        stream << '"';
+        for (const auto character : text) {
+            switch (character) {
+            case '"' : stream << "\\\""; break;
+            case '\\': stream << "\\\\"; break;
+            case '\n': stream << "\\n" ; break;
+            case '\t': stream << "\\t" ; break;
+            default  :
+                if (static_cast<unsigned char>(character) >= 0x20U) {
+                    stream << character;
+                } else {
+                    stream << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int(character) << std::setfill(' ');
+                    stream.flags(flags);
+                }
+                break;
+            }
+        }
+        stream << '"';
+    }
+};
+
+} // namespace Shos::LifeGame
@@ -8,7 +8,7 @@ namespace Shos {
 class stopwatch
 {
     bool                                               has_started;
-    std::chrono::time_point<std::chrono::system_clock> start_time;
+    std::chrono::time_point<std::chrono::steady_clock> start_time;
 
 public:
     bool is_running() const
@@ -20,7 +20,7 @@ public:
     void start()
     {
         has_started = true;
-        start_time  = std::chrono::system_clock::now();
+        start_time  = std::chrono::steady_clock::now();
     }
 
     double get_elapsed() const
@@ -28,15 +28,15 @@ public:
         if (!has_started)
             return 0.0;
 
-        const auto end_time = std::chrono::system_clock::now();  // End time
-        const auto elapsed  = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count() / 1000.0;
+        const auto end_time = std::chrono::steady_clock::now();  // End time
+        const auto elapsed  = std::chrono::duration<double>(end_time - start_time).count();
         return elapsed;
     }
 };
 
 class stopwatch_viewer final
 {
-    stopwatch stopwatch;
+    Shos::stopwatch stopwatch;
 
 public:
     void (*output)(double elapsed) = show_result;